@@ -0,0 +1,252 @@
+#include <benchmark/benchmark.h>
+
+#include <cubos/core/ecs/world.hpp>
+#include <cubos/core/ecs/world_view.hpp>
+#include <cubos/core/ecs/vec_storage.hpp>
+#include <cubos/core/ecs/map_storage.hpp>
+#include <cubos/core/ecs/archetype_storage.hpp>
+#include <cubos/core/memory/buffer_stream.hpp>
+
+#include <random>
+#include <vector>
+
+using namespace cubos::core;
+
+struct Position
+{
+    using Storage = ecs::VecStorage<Position>;
+    float x, y, z;
+};
+
+struct Velocity
+{
+    using Storage = ecs::VecStorage<Velocity>;
+    float x, y, z;
+};
+
+struct Acceleration
+{
+    using Storage = ecs::VecStorage<Acceleration>;
+    float x, y, z;
+};
+
+struct Health
+{
+    using Storage = ecs::MapStorage<Health>;
+    int hp;
+};
+
+struct ArchPosition
+{
+    using Storage = ecs::ArchetypeStorage<ArchPosition>;
+    float x, y, z;
+};
+
+struct ArchVelocity
+{
+    using Storage = ecs::ArchetypeStorage<ArchVelocity>;
+    float x, y, z;
+};
+
+/// Registers the components used by the benchmarks.
+static void registerComponents(ecs::World& world)
+{
+    world.registerComponent<Position>();
+    world.registerComponent<Velocity>();
+    world.registerComponent<Acceleration>();
+    world.registerComponent<Health>();
+}
+
+/// Creates a world where every entity has every component, except for Velocity, which only one in every
+/// sparsity entities has.
+static void populate(ecs::World& world, int64_t count, int64_t sparsity = 1)
+{
+    for (int64_t i = 0; i < count; ++i)
+    {
+        auto entity = world.create(Position{float(i), 0, 0}, Acceleration{0, -1, 0}, Health{100});
+        if (i % sparsity == 0)
+            world.addComponent<Velocity>(entity, {1, 0, 0});
+    }
+}
+
+/// Creates and then removes entities with two components.
+static void BM_EntityChurn(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        ecs::World world;
+        registerComponents(world);
+        std::vector<uint64_t> entities;
+        entities.reserve(static_cast<size_t>(state.range(0)));
+        for (int64_t i = 0; i < state.range(0); ++i)
+            entities.push_back(world.create(Position{0, 0, 0}, Health{100}));
+        for (auto entity : entities)
+            world.remove(entity);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_EntityChurn)->RangeMultiplier(10)->Range(1000, 100000)->Unit(benchmark::kMicrosecond);
+
+/// Gets components of entities picked at random, from a dense and from a map storage.
+static void BM_RandomAccess(benchmark::State& state)
+{
+    ecs::World world;
+    registerComponents(world);
+    populate(world, state.range(0));
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<uint64_t> dist(0, static_cast<uint64_t>(state.range(0) - 1));
+    std::vector<uint64_t> indices(4096);
+    for (auto& index : indices)
+        index = dist(rng);
+
+    for (auto _ : state)
+    {
+        int64_t sum = 0;
+        for (auto index : indices)
+            sum += static_cast<int64_t>(world.getComponent<Position>(index)->x) + world.getComponent<Health>(index)->hp;
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(indices.size()));
+}
+BENCHMARK(BM_RandomAccess)->RangeMultiplier(10)->Range(1000, 1000000);
+
+/// Iterates a view over one component.
+static void BM_View1(benchmark::State& state)
+{
+    ecs::World world;
+    registerComponents(world);
+    populate(world, state.range(0));
+
+    for (auto _ : state)
+    {
+        for (auto entity : ecs::WorldView<Position>(world))
+            world.getComponent<Position>(entity)->x += 1.0f;
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_View1)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMicrosecond);
+
+/// Iterates a view over two components.
+static void BM_View2(benchmark::State& state)
+{
+    ecs::World world;
+    registerComponents(world);
+    populate(world, state.range(0));
+
+    for (auto _ : state)
+    {
+        for (auto entity : ecs::WorldView<Position, Velocity>(world))
+            world.getComponent<Position>(entity)->x += world.getComponent<Velocity>(entity)->x;
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_View2)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMicrosecond);
+
+/// Iterates a view over four components, one of which is kept in a map storage.
+static void BM_View4(benchmark::State& state)
+{
+    ecs::World world;
+    registerComponents(world);
+    populate(world, state.range(0));
+
+    for (auto _ : state)
+    {
+        for (auto entity : ecs::WorldView<Position, Velocity, Acceleration, Health>(world))
+        {
+            auto* velocity = world.getComponent<Velocity>(entity);
+            velocity->y += world.getComponent<Acceleration>(entity)->y;
+            world.getComponent<Position>(entity)->y += velocity->y;
+            world.getComponent<Health>(entity)->hp -= 1;
+        }
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_View4)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMicrosecond);
+
+/// Iterates a view over two components, where only one in every N entities has the second component.
+/// Measures how much of the cost of a view is spent on entities it doesn't match.
+static void BM_ViewSparse(benchmark::State& state)
+{
+    ecs::World world;
+    registerComponents(world);
+    populate(world, state.range(0), state.range(1));
+
+    for (auto _ : state)
+    {
+        for (auto entity : ecs::WorldView<Position, Velocity>(world))
+            world.getComponent<Position>(entity)->x += world.getComponent<Velocity>(entity)->x;
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ViewSparse)
+    ->ArgsProduct({{100000, 1000000}, {1, 10, 100}})
+    ->ArgNames({"entities", "sparsity"})
+    ->Unit(benchmark::kMicrosecond);
+
+/// Creates a world which mixes dense, map and archetype storages, where half of the entities have a second archetype
+/// stored component.
+static void populateMixed(ecs::World& world, int64_t count)
+{
+    registerComponents(world);
+    world.registerComponent<ArchPosition>();
+    world.registerComponent<ArchVelocity>();
+    for (int64_t i = 0; i < count; ++i)
+    {
+        auto entity = world.create(Position{float(i), 0, 0}, Health{100}, ArchPosition{float(i), 0, 0});
+        if (i % 2 == 0)
+            world.addComponent<ArchVelocity>(entity, {1, 0, 0});
+    }
+}
+
+/// Writes a snapshot of a whole world to memory.
+static void BM_Snapshot(benchmark::State& state)
+{
+    ecs::World world;
+    populateMixed(world, state.range(0));
+
+    // Much more than the size of the snapshot.
+    std::vector<char> buffer(static_cast<size_t>(state.range(0)) * 256);
+    for (auto _ : state)
+    {
+        memory::BufferStream stream(buffer.data(), buffer.size());
+        world.snapshot(stream);
+        benchmark::DoNotOptimize(stream.tell());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Snapshot)->Arg(50000)->Unit(benchmark::kMillisecond);
+
+/// Restores a whole world from a snapshot in memory.
+static void BM_Restore(benchmark::State& state)
+{
+    ecs::World world;
+    populateMixed(world, state.range(0));
+
+    std::vector<char> buffer(static_cast<size_t>(state.range(0)) * 256);
+    memory::BufferStream stream(buffer.data(), buffer.size());
+    world.snapshot(stream);
+    size_t size = stream.tell();
+
+    for (auto _ : state)
+    {
+        memory::BufferStream snapshot(buffer.data(), size);
+        bool restored = world.restore(snapshot);
+        benchmark::DoNotOptimize(restored);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Restore)->Arg(50000)->Unit(benchmark::kMillisecond);
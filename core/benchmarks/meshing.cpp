@@ -0,0 +1,108 @@
+#include <benchmark/benchmark.h>
+
+#include <cubos/core/gl/grid.hpp>
+#include <cubos/core/gl/lod.hpp>
+#include <cubos/core/gl/vertex.hpp>
+#include <cubos/core/thread_pool.hpp>
+
+#include <cmath>
+
+using namespace cubos::core;
+
+/// Fills a grid with rolling terrain made of a few materials, which is what most chunks look like.
+static gl::Grid makeTerrain(int size)
+{
+    gl::Grid grid({unsigned(size), unsigned(size), unsigned(size)});
+    for (int z = 0; z < size; ++z)
+        for (int x = 0; x < size; ++x)
+        {
+            int height = int(size * (0.5f + 0.25f * std::sin(x * 0.3f) * std::cos(z * 0.2f)));
+            for (int y = 0; y < height; ++y)
+                grid.set({x, y, z}, y + 1 == height ? 1 : (y + 4 > height ? 2 : 3));
+        }
+    return grid;
+}
+
+/// Triangulates a chunk with the greedy mesher.
+static void BM_Triangulate(benchmark::State& state)
+{
+    auto grid = makeTerrain(static_cast<int>(state.range(0)));
+    gl::Mesh mesh;
+    for (auto _ : state)
+    {
+        mesh.vertices.clear();
+        mesh.indices.clear();
+        gl::triangulate(grid, mesh.vertices, mesh.indices);
+        benchmark::DoNotOptimize(mesh.indices.data());
+    }
+}
+BENCHMARK(BM_Triangulate)->Arg(32)->Arg(64)->Unit(benchmark::kMicrosecond);
+
+/// Triangulates a chunk with the greedy mesher, split over a thread pool.
+static void BM_TriangulateParallel(benchmark::State& state)
+{
+    auto grid = makeTerrain(static_cast<int>(state.range(0)));
+    ThreadPool pool(4);
+    gl::Mesh mesh;
+    for (auto _ : state)
+    {
+        mesh.vertices.clear();
+        mesh.indices.clear();
+        gl::triangulate(grid, mesh.vertices, mesh.indices, pool);
+        benchmark::DoNotOptimize(mesh.indices.data());
+    }
+}
+BENCHMARK(BM_TriangulateParallel)->Arg(32)->Arg(64)->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+/// Triangulates a chunk with the binary mesher.
+static void BM_TriangulateBinary(benchmark::State& state)
+{
+    auto grid = makeTerrain(static_cast<int>(state.range(0)));
+    gl::Mesh mesh;
+    for (auto _ : state)
+    {
+        mesh.vertices.clear();
+        mesh.indices.clear();
+        gl::triangulateBinary(grid, mesh.vertices, mesh.indices);
+        benchmark::DoNotOptimize(mesh.indices.data());
+    }
+}
+BENCHMARK(BM_TriangulateBinary)->Arg(32)->Arg(64)->Unit(benchmark::kMicrosecond);
+
+/// Carves a small hole in a chunk, as a destruction hit would, and triangulates every level of detail from scratch.
+static void BM_TriangulateLodsAfterHit(benchmark::State& state)
+{
+    int size = static_cast<int>(state.range(0));
+    auto grid = makeTerrain(size);
+    std::vector<gl::Mesh> meshes;
+    uint16_t mat = 0;
+    for (auto _ : state)
+    {
+        grid.set({size / 2, size / 2, size / 2}, mat);
+        mat = mat == 0 ? 1 : 0;
+        gl::triangulateLods(grid, gl::MaxLodLevels, meshes);
+        benchmark::DoNotOptimize(meshes.data());
+    }
+}
+BENCHMARK(BM_TriangulateLodsAfterHit)->Arg(64)->Arg(128)->Unit(benchmark::kMicrosecond);
+
+/// Carves a small hole in a chunk, as a destruction hit would, and updates only the affected sections of every level
+/// of detail.
+static void BM_UpdateSectionedLodsAfterHit(benchmark::State& state)
+{
+    int size = static_cast<int>(state.range(0));
+    auto grid = makeTerrain(size);
+    gl::SectionedLods lods;
+    lods.update(grid);
+    std::vector<gl::Mesh> meshes;
+    uint16_t mat = 0;
+    for (auto _ : state)
+    {
+        grid.set({size / 2, size / 2, size / 2}, mat);
+        mat = mat == 0 ? 1 : 0;
+        lods.update(grid);
+        lods.build(meshes);
+        benchmark::DoNotOptimize(meshes.data());
+    }
+}
+BENCHMARK(BM_UpdateSectionedLodsAfterHit)->Arg(64)->Arg(128)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,64 @@
+#include <benchmark/benchmark.h>
+
+#include <cubos/core/gl/grid.hpp>
+#include <cubos/core/gl/raycast.hpp>
+
+#include <cmath>
+#include <vector>
+
+using namespace cubos::core;
+
+/// Fills a grid with a floor and a few pillars, leaving most of it empty, like a level projectiles fly through.
+static gl::Grid makeLevel(int size)
+{
+    gl::Grid grid({unsigned(size), unsigned(size), unsigned(size)});
+    for (int z = 0; z < size; ++z)
+        for (int x = 0; x < size; ++x)
+        {
+            grid.set({x, 0, z}, 1);
+            if (x % 16 == 8 && z % 16 == 8)
+                for (int y = 1; y < size / 2; ++y)
+                    grid.set({x, y, z}, 2);
+        }
+    return grid;
+}
+
+/// @return Rays from above the level, aimed at points spread over its floor.
+static std::vector<std::pair<glm::vec3, glm::vec3>> makeRays(int size)
+{
+    std::vector<std::pair<glm::vec3, glm::vec3>> rays;
+    for (int i = 0; i < 1000; ++i)
+    {
+        glm::vec3 origin = {float(i % size), float(size) - 0.5f, float((i * 7) % size)};
+        glm::vec3 target = {float((i * 13) % size) + 0.5f, 0.5f, float((i * 29) % size) + 0.5f};
+        rays.emplace_back(origin, target - origin);
+    }
+    return rays;
+}
+
+/// Casts a thousand rays, visiting every voxel along them.
+static void BM_Raycast(benchmark::State& state)
+{
+    auto size = static_cast<int>(state.range(0));
+    auto grid = makeLevel(size);
+    auto rays = makeRays(size);
+    gl::RaycastHit hit;
+    for (auto _ : state)
+        for (const auto& [origin, direction] : rays)
+            benchmark::DoNotOptimize(gl::raycast(grid, origin, direction, 1000.0f, hit));
+}
+BENCHMARK(BM_Raycast)->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
+
+/// Casts a thousand rays, skipping the empty blocks of the grid.
+static void BM_RaycastPyramid(benchmark::State& state)
+{
+    auto size = static_cast<int>(state.range(0));
+    auto grid = makeLevel(size);
+    auto rays = makeRays(size);
+    gl::OccupancyPyramid pyramid(grid);
+    gl::RaycastHit hit;
+    for (auto _ : state)
+        for (const auto& [origin, direction] : rays)
+            benchmark::DoNotOptimize(gl::raycast(grid, pyramid, origin, direction, 1000.0f, hit));
+}
+BENCHMARK(BM_RaycastPyramid)->Arg(64)->Arg(256)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,152 @@
+#ifndef CUBOS_CORE_ECS_ACCESS_HPP
+#define CUBOS_CORE_ECS_ACCESS_HPP
+
+#include <type_traits>
+
+namespace cubos::core::ecs
+{
+    /// @brief Declares read-only access to a component type.
+    /// Can be used in place of a component type in a WorldView, or to declare read-only access to a component or,
+    /// wrapped in Resource, to a resource of a system.
+    /// @tparam T Component type, or Resource of a resource type.
+    template <typename T> struct Read
+    {
+    };
+
+    /// @brief Declares read and write access to a component type.
+    /// Can be used in place of a component type in a WorldView, or to declare write access to a component or,
+    /// wrapped in Resource, to a resource of a system.
+    /// @tparam T Component type, or Resource of a resource type.
+    template <typename T> struct Write
+    {
+    };
+
+    /// @brief Marks the type accessed by a Read or Write declaration of a system as a resource, such as in
+    /// Read<Resource<DeltaTime>>, so that it isn't confused with a component of the same type.
+    /// @tparam T Resource type.
+    template <typename T> struct Resource
+    {
+    };
+
+    /// @brief Kind of data accessed by a system.
+    enum class AccessKind
+    {
+        Component, ///< Components of the entities.
+        Resource,  ///< A resource of the world.
+    };
+
+    /// @brief Describes the kind of data accessed through a type used in an access declaration.
+    /// @tparam T Component type, or Resource of a resource type.
+    template <typename T> struct AccessKindTraits
+    {
+        using Type = T;
+        static constexpr AccessKind Kind = AccessKind::Component;
+    };
+
+    template <typename T> struct AccessKindTraits<Resource<T>>
+    {
+        using Type = T;
+        static constexpr AccessKind Kind = AccessKind::Resource;
+    };
+
+    /// @brief Declares read-only access to a component type, and filters out entities whose component wasn't changed
+    /// since a given tick. Components are changed when they're added or written through a Write access.
+    /// Can be used in place of a component type in a WorldView.
+    /// @tparam T Component type.
+    template <typename T> struct Changed
+    {
+    };
+
+    /// @brief Declares read-only access to a component type, and filters out entities whose component wasn't added
+    /// since a given tick.
+    /// Can be used in place of a component type in a WorldView.
+    /// @tparam T Component type.
+    template <typename T> struct Added
+    {
+    };
+
+    /// @brief Filter applied by an access declaration on the ticks of its component.
+    enum class TickFilter
+    {
+        None,    ///< No filter.
+        Changed, ///< Only entities whose component changed.
+        Added,   ///< Only entities whose component was added.
+    };
+
+    /// @brief Describes how a type used in a WorldView accesses its component.
+    /// Plain component types are accessed for reading and writing.
+    /// @tparam T Component type or access declaration.
+    template <typename T> struct AccessTraits
+    {
+        using Component = T;
+        using Reference = T&;
+        static constexpr bool Writes = true;
+        static constexpr TickFilter Filter = TickFilter::None;
+    };
+
+    template <typename T> struct AccessTraits<Read<T>>
+    {
+        using Component = T;
+        using Reference = const T&;
+        static constexpr bool Writes = false;
+        static constexpr TickFilter Filter = TickFilter::None;
+    };
+
+    template <typename T> struct AccessTraits<Write<T>>
+    {
+        using Component = T;
+        using Reference = T&;
+        static constexpr bool Writes = true;
+        static constexpr TickFilter Filter = TickFilter::None;
+    };
+
+    template <typename T> struct AccessTraits<Changed<T>>
+    {
+        using Component = T;
+        using Reference = const T&;
+        static constexpr bool Writes = false;
+        static constexpr TickFilter Filter = TickFilter::Changed;
+    };
+
+    template <typename T> struct AccessTraits<Added<T>>
+    {
+        using Component = T;
+        using Reference = const T&;
+        static constexpr bool Writes = false;
+        static constexpr TickFilter Filter = TickFilter::Added;
+    };
+
+    /// @brief Component type accessed by a component type or access declaration.
+    template <typename T> using AccessComponent = typename AccessTraits<T>::Component;
+
+    /// @brief Checks if two access declarations conflict, which happens when they access the same component or
+    /// resource and at least one of them writes to it. Resource<T> and T are different types, so a resource never
+    /// conflicts with a component.
+    /// @tparam A First access declaration.
+    /// @tparam B Second access declaration.
+    template <typename A, typename B> constexpr bool accessesConflict()
+    {
+        return std::is_same_v<AccessComponent<A>, AccessComponent<B>> &&
+               (AccessTraits<A>::Writes || AccessTraits<B>::Writes);
+    }
+
+    /// @brief Checks if any pair of distinct access declarations in a list conflict.
+    /// @tparam Accesses Access declarations.
+    template <typename... Accesses> constexpr bool hasConflictingAccess()
+    {
+        if constexpr (sizeof...(Accesses) < 2)
+        {
+            return false;
+        }
+        else
+        {
+            return []<typename First, typename... Rest>(std::type_identity<First>, std::type_identity<Rest>...)
+            {
+                return (accessesConflict<First, Rest>() || ...) || hasConflictingAccess<Rest...>();
+            }
+            (std::type_identity<Accesses>()...);
+        }
+    }
+} // namespace cubos::core::ecs
+
+#endif // CUBOS_CORE_ECS_ACCESS_HPP
@@ -0,0 +1,109 @@
+#ifndef CUBOS_CORE_ECS_ARCHETYPE_STORAGE_HPP
+#define CUBOS_CORE_ECS_ARCHETYPE_STORAGE_HPP
+
+#include <cubos/core/ecs/storage.hpp>
+#include <cubos/core/ecs/archetype_table.hpp>
+
+namespace cubos::core::ecs
+{
+
+    /// @brief ArchetypeStorage is a Storage implementation which keeps its values in the archetype table of the world,
+    /// together with the other archetype stored components of the same entity. This is best for components which are
+    /// iterated together very often, as their values are stored contiguously in chunks.
+    /// @see ArchetypeTable
+    /// @tparam T The type to be stored in the storage.
+    template <typename T> class ArchetypeStorage : public Storage<T>
+    {
+    public:
+        T* insert(uint32_t index, T value) override;
+        T* get(uint32_t index) override;
+        void erase(uint32_t index) override;
+        void markAdded(uint32_t first, size_t count, uint32_t tick) override;
+        void markChanged(uint32_t index, uint32_t tick) override;
+        ComponentTicks getTicks(uint32_t index) const override;
+        void* getRestored(size_t& column) override;
+        void clearRestored() override;
+
+        /// @brief Binds the storage to the archetype table of a world. Called when the component is registered.
+        /// @param table The archetype table.
+        void bind(ArchetypeTable& table);
+
+        /// @return The column identifier of the component in the archetype table.
+        size_t getColumn() const;
+
+    protected:
+        void insertRestored(const std::vector<uint32_t>& indices, std::vector<T>& values) override;
+
+    private:
+        ArchetypeTable* table = nullptr;
+        size_t column;
+        std::vector<T> restored; ///< Values read by the last restore, until the world moves them into the table.
+    };
+
+    template <typename T> T* ArchetypeStorage<T>::insert(uint32_t index, T value)
+    {
+        return static_cast<T*>(table->insert(index, column, &value));
+    }
+
+    template <typename T> T* ArchetypeStorage<T>::get(uint32_t index)
+    {
+        return static_cast<T*>(table->get(index, column));
+    }
+
+    template <typename T> void ArchetypeStorage<T>::erase(uint32_t index)
+    {
+        table->erase(index, column);
+    }
+
+    template <typename T> void ArchetypeStorage<T>::markAdded(uint32_t first, size_t count, uint32_t tick)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (auto* ticks = table->getTicks(first + static_cast<uint32_t>(i), column))
+                *ticks = {tick, tick};
+        }
+    }
+
+    template <typename T> void ArchetypeStorage<T>::markChanged(uint32_t index, uint32_t tick)
+    {
+        if (auto* ticks = table->getTicks(index, column))
+            ticks->changed = tick;
+    }
+
+    template <typename T> ComponentTicks ArchetypeStorage<T>::getTicks(uint32_t index) const
+    {
+        auto* ticks = table->getTicks(index, column);
+        return ticks != nullptr ? *ticks : ComponentTicks{};
+    }
+
+    template <typename T> void* ArchetypeStorage<T>::getRestored(size_t& column)
+    {
+        column = this->column;
+        return restored.empty() ? nullptr : restored.data();
+    }
+
+    template <typename T> void ArchetypeStorage<T>::clearRestored()
+    {
+        restored.clear();
+    }
+
+    template <typename T>
+    void ArchetypeStorage<T>::insertRestored(const std::vector<uint32_t>& /*indices*/, std::vector<T>& values)
+    {
+        restored = std::move(values);
+    }
+
+    template <typename T> void ArchetypeStorage<T>::bind(ArchetypeTable& table)
+    {
+        this->table = &table;
+        this->column = table.template registerColumn<T>();
+    }
+
+    template <typename T> size_t ArchetypeStorage<T>::getColumn() const
+    {
+        return column;
+    }
+
+} // namespace cubos::core::ecs
+
+#endif // CUBOS_CORE_ECS_ARCHETYPE_STORAGE_HPP
@@ -0,0 +1,194 @@
+#ifndef CUBOS_CORE_ECS_ARCHETYPE_TABLE_HPP
+#define CUBOS_CORE_ECS_ARCHETYPE_TABLE_HPP
+
+#include <cubos/core/ecs/component_ticks.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+namespace cubos::core::ecs
+{
+    /// @brief ArchetypeTable groups the components of entities by archetype, which is the set of archetype stored
+    /// components an entity has. The components of each archetype are kept in fixed-size chunks, with a structure of
+    /// arrays layout, so that iterating over the entities of an archetype streams contiguous memory. Each column array
+    /// is followed by an array with the ticks of its values, which move along with them.
+    /// Entities are moved between archetypes when components are added to or removed from them.
+    /// @see ArchetypeStorage
+    class ArchetypeTable
+    {
+    public:
+        /// Size in bytes of each chunk.
+        static constexpr size_t ChunkSize = 16 * 1024;
+
+        /// Maximum number of columns (component types) which can be registered in a table.
+        static constexpr size_t MaxColumns = 64;
+
+        /// @brief Describes how the values of a column are laid out, moved and destroyed.
+        struct ColumnInfo
+        {
+            size_t size;                                 ///< Size of each value.
+            size_t alignment;                            ///< Alignment of each value.
+            void (*moveConstruct)(void* dst, void* src); ///< Move constructs a value on uninitialized memory.
+            void (*destroy)(void* value);                ///< Destroys a value.
+        };
+
+        /// @brief A chunk of entities of a single archetype.
+        struct Chunk
+        {
+            size_t count;             ///< Number of entities in the chunk.
+            const uint32_t* entities; ///< Indices of the entities in the chunk.
+
+            /// @param column Column identifier.
+            /// @return Pointer to the first value of the column in the chunk.
+            void* column(size_t column) const;
+
+        private:
+            friend ArchetypeTable;
+
+            std::byte* data;
+            const void* archetype;
+        };
+
+        ArchetypeTable() = default;
+        ~ArchetypeTable();
+        ArchetypeTable(const ArchetypeTable&) = delete;
+        ArchetypeTable& operator=(const ArchetypeTable&) = delete;
+
+        /// @brief Registers a new column for values of type T.
+        /// @tparam T Type of the values stored in the column.
+        /// @return Column identifier.
+        template <typename T> size_t registerColumn();
+
+        /// @brief Registers a new column. Aborts if there are already MaxColumns columns, or if the values are aligned
+        /// to more than the chunks, which are aligned to 64 bytes.
+        /// @param info Description of the values stored in the column.
+        /// @return Column identifier.
+        size_t registerColumn(const ColumnInfo& info);
+
+        /// @brief Sets the value of a column of an entity, moving the entity to a new archetype if needed.
+        /// @param entity Entity index.
+        /// @param column Column identifier.
+        /// @param value Value to be moved into the table.
+        /// @return Pointer to the stored value.
+        void* insert(uint32_t entity, size_t column, void* value);
+
+        /// @brief Inserts a contiguous run of new entities, which must not be in the table yet, into the archetype
+        /// with the given columns. The archetype is found once and the values are moved in row by row.
+        /// @param first Index of the first entity.
+        /// @param count Number of entities.
+        /// @param columnCount Number of columns.
+        /// @param columns Identifiers of the columns.
+        /// @param values For each column, an array with the values of each entity, to be moved into the table.
+        void insertBatch(uint32_t first, size_t count, size_t columnCount, const size_t* columns, void* const* values);
+
+        /// @brief Inserts entities which aren't in the table yet, each with its own set of columns. Each entity is
+        /// placed directly on its final archetype, instead of migrating once per column.
+        /// @param columnCount Number of columns.
+        /// @param columns Identifiers of the columns.
+        /// @param entities For each column, the indices of the entities which have it, in ascending order.
+        /// @param counts For each column, the number of entities which have it.
+        /// @param values For each column, an array with the values of each of its entities, to be moved into the table.
+        void insertRows(size_t columnCount, const size_t* columns, const uint32_t* const* entities,
+                        const size_t* counts, void* const* values);
+
+        /// @param entity Entity index.
+        /// @param column Column identifier.
+        /// @return Pointer to the value of the column of the entity, or nullptr if it has none.
+        void* get(uint32_t entity, size_t column);
+
+        /// @param entity Entity index.
+        /// @param column Column identifier.
+        /// @return Pointer to the ticks of the value of the column of the entity, or nullptr if it has none.
+        ComponentTicks* getTicks(uint32_t entity, size_t column);
+
+        /// @brief Removes the value of a column of an entity, moving the entity to a new archetype.
+        /// @param entity Entity index.
+        /// @param column Column identifier.
+        void erase(uint32_t entity, size_t column);
+
+        /// @brief Removes every entity from the table, destroying their values. The columns stay registered.
+        void clear();
+
+        /// @brief Calls a function for each non-empty chunk of every archetype which contains the given columns.
+        /// @tparam F Function type, called with a const Chunk&.
+        /// @param columns Mask of the columns required, where each bit represents a column identifier.
+        /// @param f Function to call.
+        template <typename F> void forEachChunk(uint64_t columns, F f) const;
+
+    private:
+        /// Marks entities which aren't in any archetype.
+        static constexpr uint32_t NoArchetype = UINT32_MAX;
+
+        struct Archetype
+        {
+            uint64_t mask;                   ///< Columns present in the archetype.
+            std::vector<size_t> columns;     ///< Identifiers of the columns, in ascending order.
+            std::vector<size_t> offsets;     ///< Offset of the array of each column in a chunk.
+            std::vector<size_t> tickOffsets; ///< Offset of the ticks array of each column in a chunk.
+            size_t capacity;                 ///< Number of entities which fit in a chunk.
+            size_t chunkBytes;               ///< Number of bytes allocated per chunk.
+            std::vector<std::byte*> chunks;  ///< Allocated chunks.
+            std::vector<uint32_t> entities;  ///< Entity stored in each row.
+
+            /// @param column Column identifier.
+            /// @return Position of the column in the archetype.
+            size_t indexOf(size_t column) const;
+        };
+
+        struct Location
+        {
+            uint32_t archetype = NoArchetype;
+            uint32_t row;
+        };
+
+        uint32_t findOrCreate(uint64_t mask);
+        void* at(Archetype& archetype, size_t row, size_t index);
+        ComponentTicks* ticksAt(Archetype& archetype, size_t row, size_t index);
+        size_t pushRow(Archetype& archetype, uint32_t entity);
+        void popRow(Archetype& archetype, size_t row);
+        void migrate(uint32_t entity, uint64_t mask, size_t erased);
+
+        std::vector<ColumnInfo> columnInfos;
+        std::vector<std::unique_ptr<Archetype>> archetypes;
+        std::unordered_map<uint64_t, uint32_t> archetypeIds;
+        std::vector<Location> locations;
+    };
+
+    // Implementation
+
+    template <typename T> size_t ArchetypeTable::registerColumn()
+    {
+        return this->registerColumn({
+            sizeof(T),
+            alignof(T),
+            [](void* dst, void* src) { new (dst) T(std::move(*static_cast<T*>(src))); },
+            [](void* value) { static_cast<T*>(value)->~T(); },
+        });
+    }
+
+    template <typename F> void ArchetypeTable::forEachChunk(uint64_t columns, F f) const
+    {
+        for (auto& archetype : this->archetypes)
+        {
+            if ((archetype->mask & columns) != columns)
+                continue;
+
+            for (size_t i = 0; i * archetype->capacity < archetype->entities.size(); ++i)
+            {
+                Chunk chunk;
+                chunk.count = std::min(archetype->capacity, archetype->entities.size() - i * archetype->capacity);
+                chunk.entities = archetype->entities.data() + i * archetype->capacity;
+                chunk.data = archetype->chunks[i];
+                chunk.archetype = archetype.get();
+                f(static_cast<const Chunk&>(chunk));
+            }
+        }
+    }
+} // namespace cubos::core::ecs
+
+#endif // CUBOS_CORE_ECS_ARCHETYPE_TABLE_HPP
@@ -0,0 +1,154 @@
+#ifndef CUBOS_CORE_ECS_COMMANDS_HPP
+#define CUBOS_CORE_ECS_COMMANDS_HPP
+
+#include <cubos/core/ecs/world.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace cubos::core::ecs
+{
+
+    /// @brief Commands records structural changes to a world - creating and removing entities and adding and removing
+    /// components - so that they can be applied later, all at once, with apply. Unlike the methods of World, recording
+    /// commands is thread-safe and doesn't invalidate views, so it can be done from systems running in parallel or
+    /// while iterating a view.
+    /// Each thread records its commands into its own buffer, whose values are stored in arenas that are reused after
+    /// each apply. The commands of a thread are applied in the order they were recorded, but there is no order
+    /// between the commands of different threads.
+    class Commands
+    {
+    public:
+        /// @param world World where the commands will be applied.
+        Commands(World& world);
+
+        /// Destroys the commands which weren't applied, without applying them.
+        ~Commands();
+        Commands(const Commands&) = delete;
+        Commands& operator=(const Commands&) = delete;
+
+        /// @brief Reserves a new entity on the world, which is created on the next apply, or earlier if the world
+        /// creates its reserved entities before that.
+        /// @tparam ComponentTypes The types of the components to be added when the entity is created.
+        /// @param components The initial values for the components.
+        /// @return The identifier the entity will have.
+        template <typename... ComponentTypes> uint64_t create(ComponentTypes... components);
+
+        /// @brief Records the removal of an entity.
+        /// @param entity Entity ID.
+        void remove(uint64_t entity);
+
+        /// @brief Records the addition of a component to an entity.
+        /// @tparam T Component type.
+        /// @param entity Entity ID.
+        /// @param value Initial value of the component.
+        template <typename T> void addComponent(uint64_t entity, T value = {});
+
+        /// @brief Records the removal of a component from an entity.
+        /// @tparam T Component type to be removed.
+        /// @param entity Entity ID.
+        template <typename T> void removeComponent(uint64_t entity);
+
+        /// @brief Creates the reserved entities and applies every recorded command to the world.
+        /// Must not be called while commands are being recorded or the world is being accessed by other threads.
+        void apply();
+
+    private:
+        /// @brief A command recorded in a buffer, whose function object lives in the buffer's arena.
+        struct Command
+        {
+            void (*call)(void* object, World& world); ///< Calls the function object and destroys it.
+            void (*destroy)(void* object);          ///< Destroys the function object without calling it.
+            void* object;                           ///< Function object.
+        };
+
+        /// @brief Block of memory of an arena.
+        struct Block
+        {
+            std::unique_ptr<std::byte[]> data; ///< Memory of the block.
+            size_t size;                       ///< Size of the block in bytes.
+        };
+
+        /// @brief Commands recorded by a single thread.
+        struct Buffer
+        {
+            std::vector<Command> commands; ///< Commands in the order they were recorded.
+            std::vector<Block> blocks;     ///< Blocks of the arena, which are kept between applies.
+            size_t block = 0;              ///< Index of the block being filled.
+            size_t offset = 0;             ///< Offset of the first free byte in the block being filled.
+
+            /// @brief Allocates memory from the arena.
+            /// @param size Size of the memory in bytes.
+            /// @param alignment Alignment of the memory.
+            void* allocate(size_t size, size_t alignment);
+
+            /// @brief Destroys the commands and resets the arena, keeping its blocks.
+            /// @param world World to apply the commands to, or nullptr to destroy them without applying.
+            void flush(World* world);
+        };
+
+        /// @return The buffer of the calling thread.
+        Buffer& getBuffer();
+
+        /// @brief Records a function to be called with the world on apply.
+        /// @tparam F Function object type.
+        /// @param f Function object.
+        template <typename F> void push(F f);
+
+        World& world;
+        uint64_t id;      ///< Unique identifier, used to cache the buffer of each thread.
+        std::mutex mutex; ///< Protects the map of buffers.
+        std::unordered_map<std::thread::id, std::unique_ptr<Buffer>> buffers;
+    };
+
+    // Implementation
+
+    template <typename... ComponentTypes> uint64_t Commands::create(ComponentTypes... components)
+    {
+        uint64_t entity = world.reserve();
+        if constexpr (sizeof...(ComponentTypes) > 0)
+        {
+            push([entity, components = std::make_tuple(std::move(components)...)](World& world) {
+                std::apply([&](auto&... components) { world.addComponents(entity, components...); }, components);
+            });
+        }
+        return entity;
+    }
+
+    template <typename T> void Commands::addComponent(uint64_t entity, T value)
+    {
+        push([entity, value = std::move(value)](World& world) { world.addComponent<T>(entity, value); });
+    }
+
+    template <typename T> void Commands::removeComponent(uint64_t entity)
+    {
+        push([entity](World& world) { world.removeComponent<T>(entity); });
+    }
+
+    template <typename F> void Commands::push(F f)
+    {
+        static_assert(alignof(F) <= alignof(std::max_align_t), "Over-aligned commands aren't supported!");
+
+        auto& buffer = getBuffer();
+        void* object = new (buffer.allocate(sizeof(F), alignof(F))) F(std::move(f));
+        buffer.commands.push_back({
+            [](void* object, World& world) {
+                auto* f = static_cast<F*>(object);
+                (*f)(world);
+                f->~F();
+            },
+            [](void* object) { static_cast<F*>(object)->~F(); },
+            object,
+        });
+    }
+
+} // namespace cubos::core::ecs
+
+#endif // CUBOS_CORE_ECS_COMMANDS_HPP
@@ -0,0 +1,129 @@
+#ifndef CUBOS_CORE_ECS_COMPONENT_REGISTRY_HPP
+#define CUBOS_CORE_ECS_COMPONENT_REGISTRY_HPP
+
+#include <cubos/core/log.hpp>
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <typeinfo>
+#include <vector>
+
+/// Maximum number of component types a world can register, which must be a multiple of 32. Each entity reserves a
+/// mask bit for each of them, so that masks have a fixed size known at compile time. At most 64 of them may be stored
+/// in an ArchetypeStorage, whose archetypes are keyed by 64 bit masks.
+#ifndef CUBOS_CORE_ECS_MAX_COMPONENTS
+#define CUBOS_CORE_ECS_MAX_COMPONENTS 32
+#endif
+
+namespace cubos::core::ecs
+{
+    /// @brief Maximum number of component types a world can register.
+    constexpr size_t MaxComponents = CUBOS_CORE_ECS_MAX_COMPONENTS;
+
+    static_assert(MaxComponents > 0 && MaxComponents % 32 == 0,
+                  "CUBOS_CORE_ECS_MAX_COMPONENTS must be a positive multiple of 32!");
+
+    /// @brief Number of 32 bit words in a component mask.
+    constexpr size_t MaskWords = MaxComponents / 32;
+
+    /// @brief Set of component types, where the bit of each component is given by its identifier.
+    using ComponentMask = std::array<uint32_t, MaskWords>;
+
+    /// @brief Maps component types to the identifiers a world gave them, in the order they were registered.
+    /// Each type is given a global index the first time it's used, which indexes an array of identifiers, so that
+    /// lookups take constant time and different worlds may register the same types in different orders.
+    class ComponentRegistry
+    {
+    public:
+        /// @brief Registers a component type, giving it the next identifier.
+        /// @tparam T Component type.
+        /// @return The identifier of the component type.
+        template <typename T> size_t add();
+
+        /// @brief Gets the identifier of a component type. Aborts if the type isn't registered, as its components
+        /// have no storage to live in.
+        /// @tparam T Component type, which must be registered.
+        /// @return The identifier of the component type.
+        template <typename T> size_t id() const;
+
+        /// @tparam T Component type.
+        /// @return Whether the component type is registered.
+        template <typename T> bool contains() const;
+
+        /// @return The number of registered component types.
+        size_t size() const;
+
+    private:
+        static constexpr size_t None = SIZE_MAX;
+
+        /// @return A new global type index.
+        static size_t nextTypeIndex();
+
+        /// @tparam T Component type.
+        /// @return The global index of the component type, which is the same on every registry.
+        template <typename T> static size_t typeIndex();
+
+        std::vector<size_t> ids; ///< Identifier of each component type, indexed by global type index.
+        size_t count = 0;        ///< Number of registered component types.
+    };
+
+    // Implementation
+
+    inline size_t ComponentRegistry::size() const
+    {
+        return count;
+    }
+
+    inline size_t ComponentRegistry::nextTypeIndex()
+    {
+        static std::atomic<size_t> counter = 0;
+        return counter.fetch_add(1);
+    }
+
+    template <typename T> size_t ComponentRegistry::typeIndex()
+    {
+        static const size_t index = nextTypeIndex();
+        return index;
+    }
+
+    template <typename T> size_t ComponentRegistry::add()
+    {
+        assert(!contains<T>() && "Component type registered twice");
+        if (count >= MaxComponents)
+        {
+            logCritical("ComponentRegistry::add() failed: more than {} component types were registered, increase "
+                        "CUBOS_CORE_ECS_MAX_COMPONENTS",
+                        MaxComponents);
+            abort();
+        }
+
+        size_t index = typeIndex<T>();
+        if (index >= ids.size())
+            ids.resize(index + 1, None);
+        ids[index] = count;
+        return count++;
+    }
+
+    template <typename T> size_t ComponentRegistry::id() const
+    {
+        if (!contains<T>())
+        {
+            logCritical("ComponentRegistry::id() failed: component type \"{}\" wasn't registered", typeid(T).name());
+            abort();
+        }
+
+        return ids[typeIndex<T>()];
+    }
+
+    template <typename T> bool ComponentRegistry::contains() const
+    {
+        size_t index = typeIndex<T>();
+        return index < ids.size() && ids[index] != None;
+    }
+} // namespace cubos::core::ecs
+
+#endif // CUBOS_CORE_ECS_COMPONENT_REGISTRY_HPP
@@ -0,0 +1,17 @@
+#ifndef CUBOS_CORE_ECS_COMPONENT_TICKS_HPP
+#define CUBOS_CORE_ECS_COMPONENT_TICKS_HPP
+
+#include <cstdint>
+
+namespace cubos::core::ecs
+{
+    /// @brief Ticks on which a component value was added and last changed. Kept by each storage next to its values,
+    /// so that only entities which have the component pay for them.
+    struct ComponentTicks
+    {
+        uint32_t added = 0;   ///< Tick on which the value was added.
+        uint32_t changed = 0; ///< Tick on which the value was last changed.
+    };
+} // namespace cubos::core::ecs
+
+#endif // CUBOS_CORE_ECS_COMPONENT_TICKS_HPP
@@ -0,0 +1,121 @@
+#ifndef CUBOS_CORE_ECS_HIERARCHY_HPP
+#define CUBOS_CORE_ECS_HIERARCHY_HPP
+
+#include <glm/mat4x4.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cubos::core::ecs
+{
+    /// @brief Hierarchy keeps parent/child relationships between the entities of a world, along with their local
+    /// transforms, and caches the world transform of each entity, which is the transform of its parent multiplied by
+    /// its local transform.
+    /// The transforms are kept in breadth-first order, so that parents always come before their children and the
+    /// entities of each depth level are contiguous in memory. Changing a local transform only marks the entity as
+    /// dirty, and update walks just the subtrees below the dirty entities, leaving the rest of the hierarchy alone.
+    /// Changing the relationships invalidates the order, which is rebuilt on the next update.
+    /// Each World owns a hierarchy, from which removed entities are removed automatically.
+    class Hierarchy
+    {
+    public:
+        /// @brief Adds an entity to the hierarchy, with no parent.
+        /// @param entity Entity ID.
+        /// @param local Local transform of the entity.
+        void add(uint64_t entity, const glm::mat4& local = glm::mat4(1.0f));
+
+        /// @brief Removes an entity from the hierarchy. Its children become roots, keeping their local transforms.
+        /// @param entity Entity ID.
+        void remove(uint64_t entity);
+
+        /// @param entity Entity ID.
+        /// @return Whether the entity is in the hierarchy.
+        bool contains(uint64_t entity) const;
+
+        /// @brief Sets the parent of an entity. Both entities must be in the hierarchy. Making an entity a child of
+        /// one of its descendants would create a cycle, so it's refused.
+        /// @param child Entity ID of the child.
+        /// @param parent Entity ID of the parent.
+        /// @return False if the relationship would create a cycle, true otherwise.
+        bool setParent(uint64_t child, uint64_t parent);
+
+        /// @brief Makes an entity a root of the hierarchy.
+        /// @param child Entity ID.
+        void clearParent(uint64_t child);
+
+        /// @param entity Entity ID.
+        /// @return The entity ID of the parent of the entity, or UINT64_MAX if it has none.
+        uint64_t getParent(uint64_t entity) const;
+
+        /// @brief Sets the local transform of an entity, marking it as dirty.
+        /// @param entity Entity ID.
+        /// @param local Local transform.
+        void setLocalTransform(uint64_t entity, const glm::mat4& local);
+
+        /// @param entity Entity ID.
+        /// @return The local transform of the entity.
+        const glm::mat4& getLocalTransform(uint64_t entity) const;
+
+        /// @param entity Entity ID.
+        /// @return The world transform of the entity, as of the last update.
+        const glm::mat4& getWorldTransform(uint64_t entity) const;
+
+        /// @brief Rebuilds the order if the relationships changed and recomputes the world transforms of the dirty
+        /// entities and of their descendants.
+        void update();
+
+        /// @brief Calls a function for each entity with its world transform, in the breadth-first order computed by
+        /// the last update, where parents come before their children.
+        /// @tparam F Function type.
+        /// @param f Function called with the entity ID and its world transform.
+        template <typename F> void forEach(F f) const;
+
+    private:
+        static constexpr uint32_t None = UINT32_MAX;
+
+        /// @brief Relationships of an entity, indexed by entity index.
+        struct Node
+        {
+            uint64_t entity;                ///< Entity ID.
+            uint32_t parent = None;         ///< Index of the parent entity.
+            std::vector<uint32_t> children; ///< Indices of the child entities.
+            uint32_t position = None;       ///< Position of the entity in the transform arrays, or None if absent.
+        };
+
+        /// @brief Appends an entity to the transform arrays, without reordering.
+        void push(uint32_t index, const glm::mat4& local);
+
+        /// @brief Marks an entity as dirty, so that its subtree is recomputed on the next update.
+        void markDirty(uint32_t index);
+
+        /// @brief Detaches an entity from its parent.
+        void detach(uint32_t index);
+
+        /// @brief Sorts the transform arrays in breadth-first order.
+        void rebuild();
+
+        std::vector<Node> nodes; ///< Relationships of each entity, indexed by entity index.
+
+        // Transform arrays, indexed by position.
+        std::vector<uint32_t> order;   ///< Entity index of each position.
+        std::vector<uint32_t> parents; ///< Position of the parent of each position, or None.
+        std::vector<glm::mat4> locals; ///< Local transforms.
+        std::vector<glm::mat4> worlds; ///< Cached world transforms.
+        std::vector<uint8_t> dirty;    ///< Whether the world transform of each position must be recomputed.
+
+        std::vector<uint32_t> dirtyEntities; ///< Entity indices marked dirty since the last update.
+        std::vector<uint32_t> stack;         ///< Positions left to visit while walking a dirty subtree.
+        bool orderChanged = false;           ///< Whether the transform arrays must be reordered.
+    };
+
+    // Implementation
+
+    template <typename F> void Hierarchy::forEach(F f) const
+    {
+        for (size_t i = 0; i < order.size(); ++i)
+            f(nodes[order[i]].entity, worlds[i]);
+    }
+} // namespace cubos::core::ecs
+
+#endif // CUBOS_CORE_ECS_HIERARCHY_HPP
@@ -13,22 +13,41 @@ namespace cubos::core::ecs
     {
     public:
         T* insert(uint32_t index, T value) override;
+        void insertRange(uint32_t first, size_t count, T* values) override;
         T* get(uint32_t index) override;
         void erase(uint32_t index) override;
+        void markAdded(uint32_t first, size_t count, uint32_t tick) override;
+        void markChanged(uint32_t index, uint32_t tick) override;
+        ComponentTicks getTicks(uint32_t index) const override;
 
     private:
-        std::unordered_map<uint32_t, T> data;
+        /// @brief A value along with its ticks.
+        struct Entry
+        {
+            T value;
+            ComponentTicks ticks;
+        };
+
+        std::unordered_map<uint32_t, Entry> data;
     };
 
     template <typename T> T* MapStorage<T>::insert(uint32_t index, T value)
     {
-        data[index] = value;
-        return &data[index];
+        auto& entry = data[index];
+        entry.value = value;
+        return &entry.value;
+    }
+
+    template <typename T> void MapStorage<T>::insertRange(uint32_t first, size_t count, T* values)
+    {
+        data.reserve(data.size() + count);
+        for (size_t i = 0; i < count; ++i)
+            data[first + static_cast<uint32_t>(i)].value = std::move(values[i]);
     }
 
     template <typename T> T* MapStorage<T>::get(uint32_t index)
     {
-        return &data[index];
+        return &data.at(index).value;
     }
 
     template <typename T> void MapStorage<T>::erase(uint32_t index)
@@ -36,6 +55,29 @@ namespace cubos::core::ecs
         data.erase(index);
     }
 
+    template <typename T> void MapStorage<T>::markAdded(uint32_t first, size_t count, uint32_t tick)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto it = data.find(first + static_cast<uint32_t>(i));
+            if (it != data.end())
+                it->second.ticks = {tick, tick};
+        }
+    }
+
+    template <typename T> void MapStorage<T>::markChanged(uint32_t index, uint32_t tick)
+    {
+        auto it = data.find(index);
+        if (it != data.end())
+            it->second.ticks.changed = tick;
+    }
+
+    template <typename T> ComponentTicks MapStorage<T>::getTicks(uint32_t index) const
+    {
+        auto it = data.find(index);
+        return it != data.end() ? it->second.ticks : ComponentTicks{};
+    }
+
 } // namespace cubos::core::ecs
 
 #endif // ECS_MAP_STORAGE_HPP
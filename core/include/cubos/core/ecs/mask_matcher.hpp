@@ -0,0 +1,23 @@
+#ifndef CUBOS_CORE_ECS_MASK_MATCHER_HPP
+#define CUBOS_CORE_ECS_MASK_MATCHER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cubos::core::ecs
+{
+    /// @brief Finds, in a single pass, every entity whose component mask contains all the bits of a given mask.
+    /// The entity data is expected to have the layout used by World: for each entity, a version word followed by
+    /// its mask words. When each entity has a single mask word, the scan is vectorized with SSE2, or AVX2 if the
+    /// library is compiled with it enabled, and falls back to a scalar loop otherwise.
+    /// @param entityData Pointer to the data of the first entity.
+    /// @param stride Number of words per entity, including the version word.
+    /// @param count Number of entities to check.
+    /// @param mask Mask words required, of which there are stride - 1.
+    /// @param indices Vector to which the indices of the matching entities are appended.
+    void matchMasks(const uint32_t* entityData, size_t stride, size_t count, const uint32_t* mask,
+                    std::vector<uint32_t>& indices);
+} // namespace cubos::core::ecs
+
+#endif // CUBOS_CORE_ECS_MASK_MATCHER_HPP
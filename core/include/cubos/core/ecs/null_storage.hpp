@@ -15,9 +15,13 @@ namespace cubos::core::ecs
         T* insert(uint32_t index, T value) override;
         T* get(uint32_t index) override;
         void erase(uint32_t index) override;
+        void markAdded(uint32_t first, size_t count, uint32_t tick) override;
+        void markChanged(uint32_t index, uint32_t tick) override;
+        ComponentTicks getTicks(uint32_t index) const override;
 
     private:
         T data;
+        std::unordered_map<uint32_t, ComponentTicks> ticks; ///< Ticks of the entities which have the tag.
     };
 
     template <typename T> T* NullStorage<T>::insert(uint32_t index, T value)
@@ -32,6 +36,26 @@ namespace cubos::core::ecs
 
     template <typename T> void NullStorage<T>::erase(uint32_t index)
     {
+        ticks.erase(index);
+    }
+
+    template <typename T> void NullStorage<T>::markAdded(uint32_t first, size_t count, uint32_t tick)
+    {
+        for (size_t i = 0; i < count; ++i)
+            ticks[first + static_cast<uint32_t>(i)] = {tick, tick};
+    }
+
+    template <typename T> void NullStorage<T>::markChanged(uint32_t index, uint32_t tick)
+    {
+        auto it = ticks.find(index);
+        if (it != ticks.end())
+            it->second.changed = tick;
+    }
+
+    template <typename T> ComponentTicks NullStorage<T>::getTicks(uint32_t index) const
+    {
+        auto it = ticks.find(index);
+        return it != ticks.end() ? it->second : ComponentTicks{};
     }
 
 } // namespace cubos::core::ecs
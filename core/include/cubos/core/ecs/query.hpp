@@ -0,0 +1,157 @@
+#ifndef CUBOS_CORE_ECS_QUERY_HPP
+#define CUBOS_CORE_ECS_QUERY_HPP
+
+#include <cubos/core/ecs/world.hpp>
+#include <cubos/core/ecs/access.hpp>
+#include <cubos/core/thread_pool.hpp>
+
+#include <tuple>
+
+namespace cubos::core::ecs
+{
+
+    /// @brief Query is a persistent alternative to WorldView, for views which are iterated frequently.
+    /// The entities matched by a query are registered in the world, which keeps them up to date whenever components
+    /// are added or removed, or entities are removed. Thus, constructing a query only scans the world the first time a
+    /// query with the same components is created, and iterating it has no filtering cost.
+    /// The order in which the entities are visited is not specified, and changes as entities are added and removed.
+    /// Adding or removing components while iterating a query invalidates its iterators.
+    /// Component types may be wrapped in Read or Write to declare how they are accessed by forEachParallel.
+    /// @tparam ComponentTypes The set of component types to be iterated.
+    template <typename... ComponentTypes> class Query
+    {
+    public:
+        Query(World& w);
+
+        struct Iterator
+        {
+            const uint32_t* current;
+
+            Iterator(const uint32_t* current);
+
+            size_t operator*() const;
+
+            bool operator==(const Iterator& other) const;
+
+            bool operator!=(const Iterator& other) const;
+
+            Iterator& operator++();
+        };
+
+        Iterator begin() const;
+
+        Iterator end() const;
+
+        /// @return The number of entities matched by the query.
+        size_t size() const;
+
+        /// @brief Calls a function for each entity in the query, splitting them in chunks which run in parallel on a
+        /// thread pool. Behaves the same as WorldView::forEachParallel.
+        /// @tparam F Function type.
+        /// @param pool Thread pool where the chunks are run.
+        /// @param f Function to call.
+        /// @param grain Maximum number of entities per chunk.
+        template <typename F> void forEachParallel(ThreadPool& pool, F f, size_t grain = 256);
+
+    private:
+        World* world;
+        World::QueryState* state;
+    };
+
+    template <typename... ComponentTypes> Query<ComponentTypes...>::Query(World& w) : world(&w)
+    {
+        static_assert(sizeof...(ComponentTypes) > 0, "A query must have at least one component type!");
+        static_assert(((AccessTraits<ComponentTypes>::Filter == TickFilter::None) && ...),
+                      "Queries don't support Changed and Added filters, use a WorldView instead!");
+
+        ComponentMask mask{};
+        size_t componentIds[] = {world->getComponentID<AccessComponent<ComponentTypes>>()...};
+        for (auto id : componentIds)
+        {
+            mask[id / 32] |= 1u << (id % 32);
+        }
+
+        state = &world->getQueryState(mask);
+    }
+
+    template <typename... ComponentTypes>
+    Query<ComponentTypes...>::Iterator::Iterator(const uint32_t* current) : current(current)
+    {
+    }
+
+    template <typename... ComponentTypes> size_t Query<ComponentTypes...>::Iterator::operator*() const
+    {
+        return *current;
+    }
+
+    template <typename... ComponentTypes>
+    bool Query<ComponentTypes...>::Iterator::operator==(const Iterator& other) const
+    {
+        return current == other.current;
+    }
+
+    template <typename... ComponentTypes>
+    bool Query<ComponentTypes...>::Iterator::operator!=(const Iterator& other) const
+    {
+        return current != other.current;
+    }
+
+    template <typename... ComponentTypes>
+    typename Query<ComponentTypes...>::Iterator& Query<ComponentTypes...>::Iterator::operator++()
+    {
+        ++current;
+        return *this;
+    }
+
+    template <typename... ComponentTypes>
+    typename Query<ComponentTypes...>::Iterator Query<ComponentTypes...>::begin() const
+    {
+        return Iterator(state->entities.data());
+    }
+
+    template <typename... ComponentTypes>
+    typename Query<ComponentTypes...>::Iterator Query<ComponentTypes...>::end() const
+    {
+        return Iterator(state->entities.data() + state->entities.size());
+    }
+
+    template <typename... ComponentTypes> size_t Query<ComponentTypes...>::size() const
+    {
+        return state->entities.size();
+    }
+
+    template <typename... ComponentTypes>
+    template <typename F>
+    void Query<ComponentTypes...>::forEachParallel(ThreadPool& pool, F f, size_t grain)
+    {
+        static_assert(!hasConflictingAccess<ComponentTypes...>(),
+                      "A component can't be written while being accessed by another type in the same query!");
+
+        auto storages = std::make_tuple((Storage<AccessComponent<ComponentTypes>>*)
+                                            world->storages[world->getComponentID<AccessComponent<ComponentTypes>>()]...);
+        const auto& entities = state->entities;
+        uint32_t tick = world->tick;
+
+        pool.parallelFor(entities.size(), grain, [&](size_t begin, size_t end) {
+            std::apply(
+                [&](auto*... storages) {
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        uint32_t index = entities[i];
+                        (
+                            [&]() {
+                                if constexpr (AccessTraits<ComponentTypes>::Writes)
+                                    storages->markChanged(index, tick);
+                            }(),
+                            ...);
+                        f(size_t(index),
+                          static_cast<typename AccessTraits<ComponentTypes>::Reference>(*storages->get(index))...);
+                    }
+                },
+                storages);
+        });
+    }
+
+} // namespace cubos::core::ecs
+
+#endif // CUBOS_CORE_ECS_QUERY_HPP
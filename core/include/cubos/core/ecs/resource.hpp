@@ -0,0 +1,111 @@
+#ifndef CUBOS_CORE_ECS_RESOURCE_HPP
+#define CUBOS_CORE_ECS_RESOURCE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+
+namespace cubos::core::ecs
+{
+    /// @brief Holds a resource of a world, along with the lock which guards accesses to it.
+    struct ResourceSlot
+    {
+        virtual ~ResourceSlot() = default;
+
+        std::shared_mutex mutex; ///< Locked in shared mode by readers and exclusively by writers.
+    };
+
+    /// @brief Resource slot which holds a value of a specific type.
+    /// @tparam T Resource type.
+    template <typename T> struct TypedResourceSlot : ResourceSlot
+    {
+        TypedResourceSlot(T value) : value(std::move(value))
+        {
+        }
+
+        T value;
+    };
+
+    /// @brief Gives read-only access to a resource, which is locked in shared mode while the guard lives, so that
+    /// multiple readers can access it at the same time, but not while it's being written.
+    /// @tparam T Resource type.
+    template <typename T> class ReadResource
+    {
+    public:
+        /// @param slot Slot of the resource.
+        ReadResource(TypedResourceSlot<T>& slot) : lock(slot.mutex), value(slot.value)
+        {
+        }
+
+        /// @return The resource.
+        const T& get() const
+        {
+            return value;
+        }
+
+        const T& operator*() const
+        {
+            return value;
+        }
+
+        const T* operator->() const
+        {
+            return &value;
+        }
+
+    private:
+        std::shared_lock<std::shared_mutex> lock;
+        const T& value;
+    };
+
+    /// @brief Gives read and write access to a resource, which is locked exclusively while the guard lives.
+    /// @tparam T Resource type.
+    template <typename T> class WriteResource
+    {
+    public:
+        /// @param slot Slot of the resource.
+        WriteResource(TypedResourceSlot<T>& slot) : lock(slot.mutex), value(slot.value)
+        {
+        }
+
+        /// @return The resource.
+        T& get() const
+        {
+            return value;
+        }
+
+        T& operator*() const
+        {
+            return value;
+        }
+
+        T* operator->() const
+        {
+            return &value;
+        }
+
+    private:
+        std::unique_lock<std::shared_mutex> lock;
+        T& value;
+    };
+
+    /// @brief Assigns a new resource type identifier.
+    inline size_t nextResourceID()
+    {
+        static std::atomic<size_t> counter = 0;
+        return counter.fetch_add(1);
+    }
+
+    /// @brief Gets the identifier of a resource type, which is the same on every world.
+    /// Identifiers are assigned sequentially, the first time each type is used, so that they can index arrays.
+    /// @tparam T Resource type.
+    template <typename T> size_t getResourceID()
+    {
+        static const size_t id = nextResourceID();
+        return id;
+    }
+} // namespace cubos::core::ecs
+
+#endif // CUBOS_CORE_ECS_RESOURCE_HPP
@@ -0,0 +1,108 @@
+#ifndef CUBOS_CORE_ECS_SCHEDULER_HPP
+#define CUBOS_CORE_ECS_SCHEDULER_HPP
+
+#include <cubos/core/ecs/access.hpp>
+#include <cubos/core/ecs/world.hpp>
+#include <cubos/core/thread_pool.hpp>
+
+#include <functional>
+#include <string>
+#include <typeindex>
+#include <vector>
+
+namespace cubos::core::ecs
+{
+    /// @brief A system is a function which runs over a world every frame, declaring which components it reads
+    /// and writes so that it can be scheduled in parallel with systems it doesn't conflict with.
+    struct System
+    {
+        /// @brief Describes the access of a system to a component or resource type.
+        struct Access
+        {
+            std::type_index type; ///< Component or resource type.
+            AccessKind kind;      ///< Whether the type is accessed as a component or as a resource.
+            bool writes;          ///< Whether the component or resource is written.
+
+            /// @tparam A Access declaration, such as Read<T> or Write<Resource<T>>.
+            /// @return The access described by the declaration.
+            template <typename A> static Access of()
+            {
+                using Traits = AccessKindTraits<AccessComponent<A>>;
+                return {typeid(typename Traits::Type), Traits::Kind, AccessTraits<A>::Writes};
+            }
+        };
+
+        std::string name;                     ///< Name of the system, used in timing reports.
+        std::vector<Access> accesses;         ///< Components and resources accessed by the system.
+        bool exclusive;                       ///< Whether the system requires exclusive access to the world.
+        std::function<void(World&)> function; ///< Function which runs the system.
+
+        /// @param other Another system.
+        /// @return True if the two systems can't run at the same time.
+        bool conflictsWith(const System& other) const;
+    };
+
+    /// @brief Scheduler runs the systems registered on it. Every time the systems are run, the scheduler builds a
+    /// dependency graph between them, where a system depends on the earlier registered systems it conflicts with, and
+    /// runs systems without pending dependencies concurrently on a thread pool.
+    /// Systems which run in parallel must only access the components they declare, and must not create or remove
+    /// entities or components. Systems which do so should be added with addExclusiveSystem.
+    class Scheduler
+    {
+    public:
+        /// @brief Time taken by a system on the last run.
+        struct Timing
+        {
+            std::string name;    ///< Name of the system.
+            double milliseconds; ///< Time taken.
+        };
+
+        /// @brief Adds a system.
+        /// @tparam Accesses Access declarations of the system, such as Read<T> or Write<T> of components, or
+        /// Read<Resource<T>> or Write<Resource<T>> of resources.
+        /// @tparam F Function type.
+        /// @param name Name of the system.
+        /// @param f Function called with the world when the system runs.
+        template <typename... Accesses, typename F> void addSystem(std::string name, F f);
+
+        /// @brief Adds a system which conflicts with every other system, and thus never runs in parallel.
+        /// @tparam F Function type.
+        /// @param name Name of the system.
+        /// @param f Function called with the world when the system runs.
+        template <typename F> void addExclusiveSystem(std::string name, F f);
+
+        /// @brief Runs every system once, waiting for all of them to finish.
+        /// @param world World to run the systems on.
+        /// @param pool Thread pool where the systems run.
+        void run(World& world, ThreadPool& pool);
+
+        /// @return The time taken by each system on the last run, in the order they were added.
+        const std::vector<Timing>& getTimings() const;
+
+        /// @brief Logs the time taken by each system on the last run, from slowest to fastest.
+        void logTimings() const;
+
+    private:
+        std::vector<System> systems;
+        std::vector<Timing> timings;
+    };
+
+    // Implementation
+
+    template <typename... Accesses, typename F> void Scheduler::addSystem(std::string name, F f)
+    {
+        static_assert(!hasConflictingAccess<Accesses...>(),
+                      "A system can't declare conflicting accesses to the same component!");
+
+        System system{std::move(name), {}, false, std::move(f)};
+        (system.accesses.push_back(System::Access::of<Accesses>()), ...);
+        this->systems.push_back(std::move(system));
+    }
+
+    template <typename F> void Scheduler::addExclusiveSystem(std::string name, F f)
+    {
+        this->systems.push_back({std::move(name), {}, true, std::move(f)});
+    }
+} // namespace cubos::core::ecs
+
+#endif // CUBOS_CORE_ECS_SCHEDULER_HPP
@@ -0,0 +1,127 @@
+#ifndef CUBOS_CORE_ECS_SPARSE_SET_STORAGE_HPP
+#define CUBOS_CORE_ECS_SPARSE_SET_STORAGE_HPP
+
+#include <cubos/core/ecs/storage.hpp>
+
+namespace cubos::core::ecs
+{
+
+    /// @brief SparseSetStorage is a Storage implementation that keeps its values packed in a dense array, along with
+    /// the indices of the entities that own them, and a sparse array which maps entity indices to positions in the
+    /// dense array. Insertion and removal are O(1) and iterating over the stored values visits only the entities
+    /// that have them, which makes it a good fit for components that are iterated often but not present in every
+    /// entity.
+    /// @tparam T The type to be stored in the storage.
+    template <typename T> class SparseSetStorage : public Storage<T>
+    {
+    public:
+        T* insert(uint32_t index, T value) override;
+        void insertRange(uint32_t first, size_t count, T* values) override;
+        T* get(uint32_t index) override;
+        void erase(uint32_t index) override;
+        bool getPacked(const uint32_t*& indices, size_t& count) const override;
+        void markAdded(uint32_t first, size_t count, uint32_t tick) override;
+        void markChanged(uint32_t index, uint32_t tick) override;
+        ComponentTicks getTicks(uint32_t index) const override;
+
+    private:
+        static constexpr uint32_t Empty = UINT32_MAX;
+
+        std::vector<uint32_t> sparse;      ///< Position of the value of each entity in the dense arrays.
+        std::vector<uint32_t> owners;      ///< Entity which owns each value.
+        std::vector<T> dense;              ///< Packed values.
+        std::vector<ComponentTicks> ticks; ///< Ticks of each packed value.
+    };
+
+    template <typename T> T* SparseSetStorage<T>::insert(uint32_t index, T value)
+    {
+        if (sparse.size() <= index)
+            sparse.resize(index + 1, Empty);
+
+        if (sparse[index] != Empty)
+        {
+            dense[sparse[index]] = std::move(value);
+        }
+        else
+        {
+            sparse[index] = static_cast<uint32_t>(dense.size());
+            owners.push_back(index);
+            dense.push_back(std::move(value));
+            ticks.emplace_back();
+        }
+
+        return &dense[sparse[index]];
+    }
+
+    template <typename T> void SparseSetStorage<T>::insertRange(uint32_t first, size_t count, T* values)
+    {
+        if (sparse.size() < first + count)
+            sparse.resize(first + count, Empty);
+        owners.reserve(owners.size() + count);
+        dense.reserve(dense.size() + count);
+        ticks.reserve(ticks.size() + count);
+
+        for (size_t i = 0; i < count; ++i)
+            insert(first + static_cast<uint32_t>(i), std::move(values[i]));
+    }
+
+    template <typename T> T* SparseSetStorage<T>::get(uint32_t index)
+    {
+        return &dense[sparse[index]];
+    }
+
+    template <typename T> void SparseSetStorage<T>::erase(uint32_t index)
+    {
+        if (sparse.size() <= index || sparse[index] == Empty)
+            return;
+
+        // Swap the erased value with the last one and pop it. The last value is just popped, as moving it onto
+        // itself would be a self-move-assignment.
+        uint32_t position = sparse[index];
+        if (position != dense.size() - 1)
+        {
+            uint32_t last = owners.back();
+            dense[position] = std::move(dense.back());
+            owners[position] = last;
+            ticks[position] = ticks.back();
+            sparse[last] = position;
+        }
+
+        dense.pop_back();
+        owners.pop_back();
+        ticks.pop_back();
+        sparse[index] = Empty;
+    }
+
+    template <typename T> bool SparseSetStorage<T>::getPacked(const uint32_t*& indices, size_t& count) const
+    {
+        indices = owners.data();
+        count = owners.size();
+        return true;
+    }
+
+    template <typename T> void SparseSetStorage<T>::markAdded(uint32_t first, size_t count, uint32_t tick)
+    {
+        for (size_t i = 0; i < count && first + i < sparse.size(); ++i)
+        {
+            if (sparse[first + i] != Empty)
+                ticks[sparse[first + i]] = {tick, tick};
+        }
+    }
+
+    template <typename T> void SparseSetStorage<T>::markChanged(uint32_t index, uint32_t tick)
+    {
+        if (index < sparse.size() && sparse[index] != Empty)
+            ticks[sparse[index]].changed = tick;
+    }
+
+    template <typename T> ComponentTicks SparseSetStorage<T>::getTicks(uint32_t index) const
+    {
+        if (index < sparse.size() && sparse[index] != Empty)
+            return ticks[sparse[index]];
+        return {};
+    }
+
+} // namespace cubos::core::ecs
+
+#endif // CUBOS_CORE_ECS_SPARSE_SET_STORAGE_HPP
@@ -1,18 +1,94 @@
 #ifndef CUBOS_CORE_ECS_STORAGE_HPP
 #define CUBOS_CORE_ECS_STORAGE_HPP
 
+#include <cubos/core/memory/binary_serializer.hpp>
+#include <cubos/core/memory/binary_deserializer.hpp>
+#include <cubos/core/ecs/component_ticks.hpp>
+
+#include <algorithm>
 #include <unordered_map>
 #include <vector>
+#include <cstddef>
 #include <cstdint>
+#include <type_traits>
+#include <utility>
 
 namespace cubos::core::ecs
 {
 
+    /// @brief Outcome of restoring the values of a storage from a snapshot.
+    enum class RestoreResult
+    {
+        Restored,  ///< The values were read and inserted.
+        Skipped,   ///< The values weren't written to the snapshot, so nothing was inserted.
+        Truncated, ///< The stream ended before the values were read.
+    };
+
     /// IStorage is an abstract parent class for all storages.
     class IStorage
     {
     public:
         virtual ~IStorage() = default;
+
+        /// @brief Remove a value from the storage.
+        /// @param index The index of the value to be removed.
+        virtual void erase(uint32_t index) = 0;
+
+        /// @brief Gets the indices of the entities which have a value in the storage, if the storage keeps them
+        /// packed. Used to iterate only over the entities which have the component.
+        /// @param indices Set to the packed indices.
+        /// @param count Set to the number of indices.
+        /// @return True if the storage keeps packed indices, false otherwise.
+        virtual bool getPacked(const uint32_t*& /*indices*/, size_t& /*count*/) const
+        {
+            return false;
+        }
+
+        /// @brief Writes the values of the given entities to a stream, so that they can be restored later.
+        /// The values are preceded by a byte which tells if they could be written at all.
+        /// @param stream The stream to write to.
+        /// @param indices The indices of the entities, which must all have a value in the storage.
+        /// @return False if the values can't be written, in which case only the leading byte is written.
+        virtual bool snapshot(memory::Stream& stream, const std::vector<uint32_t>& indices) = 0;
+
+        /// @brief Reads values written by snapshot and inserts them into the storage.
+        /// @param stream The stream to read from.
+        /// @param indices The indices of the entities, in the same order as when they were written.
+        /// @return Skipped if the values weren't written, in which case nothing is inserted, or Truncated if the
+        /// stream ended before all of them were read.
+        virtual RestoreResult restore(memory::Stream& stream, const std::vector<uint32_t>& indices) = 0;
+
+        /// @brief Gets the values read by the last restore which the storage is holding on to, instead of inserting
+        /// them. Archetype storages do this so that the world can then move each entity into its final archetype at
+        /// once, with the values of all of its archetype stored components.
+        /// @param column Set to the column of the storage in the archetype table.
+        /// @return Pointer to the held values, one per restored entity, or nullptr if there are none.
+        virtual void* getRestored(size_t& /*column*/)
+        {
+            return nullptr;
+        }
+
+        /// @brief Destroys the values held since the last restore, after they were moved out of them.
+        virtual void clearRestored()
+        {
+        }
+
+        /// @brief Marks the values of a contiguous run of entities as added, and thus also changed, on a tick. The
+        /// values must have already been inserted.
+        /// @param first The index of the first entity.
+        /// @param count The number of entities.
+        /// @param tick The tick of the world.
+        virtual void markAdded(uint32_t first, size_t count, uint32_t tick) = 0;
+
+        /// @brief Marks the value of an entity as changed on a tick. Does nothing if the entity has no value.
+        /// Multiple threads may mark the values of different entities at the same time.
+        /// @param index The index of the entity.
+        /// @param tick The tick of the world.
+        virtual void markChanged(uint32_t index, uint32_t tick) = 0;
+
+        /// @param index The index of the entity.
+        /// @return The ticks of the value of the entity, or zeroed ticks if it has no value.
+        virtual ComponentTicks getTicks(uint32_t index) const = 0;
     };
 
     /// @brief Storage is an abstract container for a certain type with common operations, such as,
@@ -28,13 +104,100 @@ namespace cubos::core::ecs
         /// @param value The value to be inserted.
         virtual T* insert(uint32_t index, T value) = 0;
 
+        /// @brief Inserts values for a contiguous run of entities. Storages which can do better than inserting the
+        /// values one by one, such as by growing their containers only once, should override this.
+        /// @param first The index of the first entity.
+        /// @param count The number of values to be inserted.
+        /// @param values The values to be moved into the storage.
+        virtual void insertRange(uint32_t first, size_t count, T* values)
+        {
+            for (size_t i = 0; i < count; ++i)
+                insert(first + static_cast<uint32_t>(i), std::move(values[i]));
+        }
+
         /// @brief Gets a value from the storage.
         /// @param index The index of the value to be retrieved.
         virtual T* get(uint32_t index) = 0;
 
-        /// @brief Remove a value from the storage.
-        /// @param index The index of the value to be removed.
-        virtual void erase(uint32_t index) = 0;
+        /// @brief Trivially copyable values are gathered and written as a single raw block. Other values are written
+        /// with a BinarySerializer, and thus must be serializable and deserializable.
+        bool snapshot(memory::Stream& stream, const std::vector<uint32_t>& indices) override
+        {
+            if constexpr (std::is_trivially_copyable_v<T>)
+            {
+                std::vector<T> values;
+                values.reserve(indices.size());
+                for (auto index : indices)
+                    values.push_back(*get(index));
+                stream.put(1);
+                if (!values.empty())
+                    stream.write(values.data(), values.size() * sizeof(T));
+                return true;
+            }
+            else if constexpr (memory::TriviallySerializable<T> && memory::TriviallyDeserializable<T>)
+            {
+                memory::BinarySerializer binary(stream);
+                memory::Serializer& serializer = binary;
+                stream.put(1);
+                for (auto index : indices)
+                    serializer.write(*get(index), nullptr);
+                return true;
+            }
+            else
+            {
+                stream.put(0);
+                return false;
+            }
+        }
+
+        RestoreResult restore(memory::Stream& stream, const std::vector<uint32_t>& indices) override
+        {
+            char written;
+            if (stream.read(&written, sizeof(written)) != sizeof(written))
+                return RestoreResult::Truncated;
+            if (written == 0)
+                return RestoreResult::Skipped;
+
+            if constexpr (std::is_trivially_copyable_v<T>)
+            {
+                std::vector<T> values(indices.size());
+                if (!values.empty() &&
+                    stream.read(values.data(), values.size() * sizeof(T)) != values.size() * sizeof(T))
+                    return RestoreResult::Truncated;
+                insertRestored(indices, values);
+            }
+            else if constexpr (memory::TriviallySerializable<T> && memory::TriviallyDeserializable<T>)
+            {
+                // The values are only inserted once all of them were read, as with trivially copyable values.
+                memory::BinaryDeserializer binary(stream);
+                memory::Deserializer& deserializer = binary;
+                std::vector<T> values(indices.size());
+                for (auto& value : values)
+                    deserializer.read(value);
+                if (binary.failed())
+                    return RestoreResult::Truncated;
+                insertRestored(indices, values);
+            }
+
+            return RestoreResult::Restored;
+        }
+
+    protected:
+        /// @brief Inserts the values read by restore. By default, each contiguous run of entities is inserted with
+        /// insertRange.
+        /// @param indices The indices of the entities, in ascending order.
+        /// @param values The values of each entity, to be moved into the storage.
+        virtual void insertRestored(const std::vector<uint32_t>& indices, std::vector<T>& values)
+        {
+            for (size_t i = 0; i < indices.size();)
+            {
+                size_t end = i + 1;
+                while (end < indices.size() && indices[end] == indices[end - 1] + 1)
+                    ++end;
+                insertRange(indices[i], end - i, values.data() + i);
+                i = end;
+            }
+        }
     };
 
 } // namespace cubos::core::ecs
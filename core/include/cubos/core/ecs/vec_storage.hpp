@@ -13,11 +13,16 @@ namespace cubos::core::ecs
     {
     public:
         T* insert(uint32_t index, T value) override;
+        void insertRange(uint32_t first, size_t count, T* values) override;
         T* get(uint32_t index) override;
         void erase(uint32_t index) override;
+        void markAdded(uint32_t first, size_t count, uint32_t tick) override;
+        void markChanged(uint32_t index, uint32_t tick) override;
+        ComponentTicks getTicks(uint32_t index) const override;
 
     private:
         std::vector<T> data;
+        std::vector<ComponentTicks> ticks; ///< Ticks of each value, indexed by entity like the values.
     };
 
     template <typename T> T* VecStorage<T>::insert(uint32_t index, T value)
@@ -35,6 +40,15 @@ namespace cubos::core::ecs
         return &data[index];
     }
 
+    template <typename T> void VecStorage<T>::insertRange(uint32_t first, size_t count, T* values)
+    {
+        if (data.size() < first + count)
+            data.resize(first + count);
+
+        for (size_t i = 0; i < count; ++i)
+            data[first + i] = std::move(values[i]);
+    }
+
     template <typename T> T* VecStorage<T>::get(uint32_t index)
     {
         return &data[index];
@@ -44,6 +58,26 @@ namespace cubos::core::ecs
     {
         data[index].~T();
         new (&data[index]) T;
+        if (index < ticks.size())
+            ticks[index] = {};
+    }
+
+    template <typename T> void VecStorage<T>::markAdded(uint32_t first, size_t count, uint32_t tick)
+    {
+        if (ticks.size() < first + count)
+            ticks.resize(first + count);
+        std::fill_n(ticks.begin() + first, count, ComponentTicks{tick, tick});
+    }
+
+    template <typename T> void VecStorage<T>::markChanged(uint32_t index, uint32_t tick)
+    {
+        if (index < ticks.size())
+            ticks[index].changed = tick;
+    }
+
+    template <typename T> ComponentTicks VecStorage<T>::getTicks(uint32_t index) const
+    {
+        return index < ticks.size() ? ticks[index] : ComponentTicks{};
     }
 
 } // namespace cubos::core::ecs
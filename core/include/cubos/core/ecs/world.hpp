@@ -1,10 +1,26 @@
 #ifndef CUBOS_ECS_WORLD_HPP
 #define CUBOS_ECS_WORLD_HPP
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cinttypes>
-
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#include <cubos/core/log.hpp>
 #include <cubos/core/ecs/storage.hpp>
+#include <cubos/core/ecs/archetype_storage.hpp>
+#include <cubos/core/ecs/component_registry.hpp>
+#include <cubos/core/ecs/hierarchy.hpp>
+#include <cubos/core/ecs/resource.hpp>
 
 namespace cubos::core::ecs
 {
@@ -22,13 +38,58 @@ namespace cubos::core::ecs
         /// @param components The initial values for the components.
         template <typename... ComponentTypes> uint64_t create(ComponentTypes... components);
 
-        /// @brief Removes an entity.
+        /// @brief Creates a contiguous run of new entities with the same components at once.
+        /// The entity data grows only once, the masks are written in bulk and each storage receives all of the values
+        /// of its component in a single call.
+        /// @tparam ComponentTypes The types of the components of the new entities.
+        /// @tparam F Generator function type.
+        /// @param count Number of entities to create.
+        /// @param generator Called with the index of each new entity in the batch, starting at zero, and a reference
+        /// to each of its default constructed components, which it should fill.
+        /// @return The ID of the first entity created. The IDs of the other entities follow it.
+        template <typename... ComponentTypes, typename F> uint64_t createBatch(size_t count, F generator);
+
+        /// @brief Reserves an entity ID, which only becomes a valid entity, with no components, once createReserved
+        /// is called. Unlike the other methods of World, reserving is lock-free and thread-safe, so parallel jobs can
+        /// reserve IDs and create the entities later. It must only run concurrently with other calls to reserve.
+        /// Indices of removed entities are reused first, with their version incremented, and then new indices are
+        /// handed out.
+        /// @return The ID the entity will have.
+        uint64_t reserve();
+
+        /// @brief Creates the entities reserved with reserve since the last call. Structural changes to the world,
+        /// such as creating or removing entities, call it implicitly before doing anything else.
+        void createReserved();
+
+        /// @brief Removes an entity. Its index is reused by entities created later, with a new version.
         /// @param entity Entity ID.
         void remove(uint64_t entity);
 
-        /// @brief Register a component type.
+        /// @brief Removes multiple entities at once. Entities which were already removed are ignored.
+        /// Components are erased storage by storage, instead of entity by entity.
+        /// @param entities Entity IDs.
+        void removeBatch(std::span<const uint64_t> entities);
+
+        /// @brief Writes the entities and components of the world to a stream, in a binary format meant to be
+        /// restored later on the same platform, such as for rollback or replays. Trivially copyable components are
+        /// written as raw blocks, other components are written with their serialize method. Components which are
+        /// neither are skipped, and thus removed when restored.
+        /// @param stream Stream to write to.
+        void snapshot(memory::Stream& stream) const;
+
+        /// @brief Replaces the entities and components of the world with the ones of a snapshot. The world must have
+        /// the same component types registered, in the same order, as the world from which the snapshot was taken.
+        /// The stream must be seekable, so that its length can be checked before the entities are allocated.
+        /// @param stream Stream to read from.
+        /// @return False if the stream doesn't contain a compatible snapshot or its entities are truncated, in which
+        /// case the world is unchanged, or if it ends while reading the components, in which case the entities are
+        /// restored without the components which couldn't be read.
+        bool restore(memory::Stream& stream);
+
+        /// @brief Register a component type. Each world identifies its component types in the order they were
+        /// registered, up to MaxComponents, which is set at compile time through CUBOS_CORE_ECS_MAX_COMPONENTS.
         /// @tparam T Component type.
-        /// @param storage Storage for the component type.
+        /// @return The identifier of the component type in this world.
         template <typename T> size_t registerComponent();
 
         /// @brief Add a component to an entity.
@@ -57,58 +118,216 @@ namespace cubos::core::ecs
         /// @param entity Entity ID.
         template <typename... ComponentTypes> void removeComponents(uint64_t entity);
 
-        template <typename... ComponentTypes> friend class WorldView;
+        /// @brief Marks a component of an entity as changed on the current tick. Components written through a
+        /// Write access in a view are marked automatically, but components written through getComponent aren't.
+        /// @tparam T Component type.
+        /// @param entity Entity ID.
+        template <typename T> void markChanged(uint64_t entity);
+
+        /// @return The current tick, on which components added or changed are marked.
+        uint32_t getTick() const;
+
+        /// @brief Advances the current tick, usually once per frame. Views created with the tick returned by
+        /// getTick before advancing see, through Changed and Added, the components touched since then.
+        /// @return The previous tick.
+        uint32_t advanceTick();
+
+        /// @brief Gets the parent/child relationships and transforms of the entities of the world. Entities removed
+        /// from the world are removed from it too, turning their children into roots.
+        /// @return The hierarchy of the world.
+        Hierarchy& getHierarchy();
+
+        /// @return The hierarchy of the world.
+        const Hierarchy& getHierarchy() const;
+
+        /// @brief Inserts a resource, which is a global value of which the world holds at most one per type, replacing
+        /// the previous value if there was one. Must not be called while the resource is being accessed.
+        /// Resources take the place of singleton components: they're found in constant time, without a view.
+        /// @tparam T Resource type.
+        /// @param value Value of the resource.
+        template <typename T> void insertResource(T value = {});
+
+        /// @brief Removes a resource, if it exists. Must not be called while the resource is being accessed.
+        /// @tparam T Resource type.
+        template <typename T> void removeResource();
+
+        /// @tparam T Resource type.
+        /// @return Whether the world holds a resource of the given type.
+        template <typename T> bool hasResource() const;
+
+        /// @brief Gets read-only access to a resource, which must exist. The resource is locked for reading while
+        /// the returned guard lives, so multiple systems may read it at the same time. Aborts if it doesn't exist.
+        /// Systems which access resources can declare them with Read<Resource<T>> and Write<Resource<T>> on the
+        /// scheduler, so that they're only run in parallel with systems that don't conflict with them.
+        /// @tparam T Resource type.
+        /// @return Guard which gives access to the resource.
+        template <typename T> ReadResource<T> read();
+
+        /// @brief Gets read and write access to a resource, which must exist. The resource is locked exclusively
+        /// while the returned guard lives. Aborts if it doesn't exist.
+        /// @tparam T Resource type.
+        /// @return Guard which gives access to the resource.
+        template <typename T> WriteResource<T> write();
+
+        /// @brief Calls a function for each chunk of entities which have all of the given components.
+        /// All of the component types must be stored in an ArchetypeStorage.
+        /// The function is called with the number of entities in the chunk, a pointer to their indices and a pointer
+        /// to the contiguous array of each component, in the same order as the component types.
+        /// @tparam ComponentTypes Component types.
+        /// @tparam F Function type.
+        /// @param f Function to be called for each chunk.
+        template <typename... ComponentTypes, typename F> void forEachChunk(F f);
+
+        template <typename... ComponentTypes> friend struct WorldView;
+        template <typename... ComponentTypes> friend class Query;
+        friend class Commands;
 
     private:
+        /// @brief Entities matched by a persistent query, which are kept up to date whenever the components of an
+        /// entity change.
+        struct QueryState
+        {
+            ComponentMask mask;              ///< Components required by the query.
+            std::vector<uint32_t> entities;  ///< Indices of the matching entities.
+            std::vector<uint32_t> positions; ///< Position of each entity in the entities vector.
+        };
+
         std::vector<std::uint32_t> entityData;
         std::vector<std::uint32_t> availableEntities;
+
+        /// Number of available entities which weren't reserved yet. When negative, its absolute value is the number
+        /// of new entities reserved after the available ones ran out.
+        std::atomic<int64_t> freeCursor = 0;
+
         std::vector<IStorage*> storages;
+        ArchetypeTable archetypes;
+        std::vector<std::unique_ptr<QueryState>> queries;
+        std::vector<std::unique_ptr<ResourceSlot>> resources; ///< Resources, indexed by resource type identifier.
+        Hierarchy hierarchy;                                  ///< Relationships and transforms of the entities.
 
         size_t nextEntityId = 0;
-        size_t elementsPerEntity;
+        uint32_t tick = 1;
+        ComponentRegistry registry;
+
+        /// Number of words per entity: a version word followed by the component mask, whose size is fixed.
+        static constexpr size_t elementsPerEntity = 1 + MaskWords;
+
+        /// @brief Gets the indices of the entities which have each component.
+        /// @return For each component, the indices of the entities which have it.
+        std::vector<std::vector<uint32_t>> getComponentOwners() const;
+
+        /// @brief Appends new entities with no components, growing the entity data only once.
+        /// @param count Number of entities to append.
+        /// @return Index of the first appended entity.
+        uint32_t appendEntities(size_t count);
+
+        /// @brief Gets the state of the query with the given mask, creating it if it doesn't exist yet.
+        /// @param mask Components required by the query.
+        QueryState& getQueryState(const ComponentMask& mask);
+
+        /// @brief Adds or removes an entity from the queries, after its mask changes.
+        /// @param entityIndex Entity index.
+        void updateQueries(uint32_t entityIndex);
 
         template <typename T> size_t getComponentID();
+
+        /// @brief Gets the slot of a resource. Aborts if the resource doesn't exist.
+        /// @tparam T Resource type.
+        /// @return The slot of the resource.
+        template <typename T> TypedResourceSlot<T>& getResourceSlot();
+        template <typename T> static constexpr bool isArchetypeStored();
     };
 
     template <typename T> size_t World::getComponentID()
     {
-        static size_t id = storages.size();
-        return id;
+        return registry.id<T>();
     }
 
-    template <typename... ComponentTypes> uint64_t World::create(ComponentTypes... components)
+    template <typename T> constexpr bool World::isArchetypeStored()
     {
-        if (entityData.size() == 0)
-            elementsPerEntity = 1 + (31 + storages.size()) / 32;
+        return std::is_base_of_v<ArchetypeStorage<T>, typename T::Storage>;
+    }
 
-        uint64_t id;
-        if (!availableEntities.empty())
-        {
-            uint32_t index = availableEntities.back();
-            uint32_t version = entityData[elementsPerEntity * index];
-            id = ((uint64_t)version << 32) | index;
-        }
-        else
-        {
-            id = nextEntityId++;
-            for (size_t i = 0; i < elementsPerEntity; i++)
-            {
-                entityData.push_back(0);
-            }
-        }
+    template <typename... ComponentTypes> uint64_t World::create(ComponentTypes... components)
+    {
+        createReserved();
+        uint64_t id = reserve();
+        createReserved();
 
         addComponents(id, components...);
 
         return id;
     }
 
+    template <typename... ComponentTypes, typename F> uint64_t World::createBatch(size_t count, F generator)
+    {
+        // The batch always gets new indices, so that its IDs are contiguous.
+        createReserved();
+        uint32_t first = appendEntities(count);
+        if (count == 0)
+            return first;
+
+        std::tuple<std::vector<ComponentTypes>...> values{std::vector<ComponentTypes>(count)...};
+        std::apply(
+            [&](auto&... values) {
+                for (size_t i = 0; i < count; ++i)
+                    generator(i, values[i]...);
+            },
+            values);
+
+        // All entities share the same mask, which is copied to each of them.
+        ComponentMask mask{};
+        ((mask[getComponentID<ComponentTypes>() / 32] |= 1u << (getComponentID<ComponentTypes>() % 32)), ...);
+        for (size_t i = 0; i < count; ++i)
+            std::copy(mask.begin(), mask.end(), &entityData[(first + i) * elementsPerEntity + 1]);
+
+        // Archetype stored components are inserted together, so that each entity is placed directly on its final
+        // archetype. The other components are inserted storage by storage.
+        size_t columns[sizeof...(ComponentTypes) + 1];
+        void* columnValues[sizeof...(ComponentTypes) + 1];
+        size_t columnCount = 0;
+        std::apply(
+            [&](auto&... values) {
+                (
+                    [&](auto& values) {
+                        using T = typename std::decay_t<decltype(values)>::value_type;
+                        auto* storage = (Storage<T>*)storages[getComponentID<T>()];
+                        if constexpr (isArchetypeStored<T>())
+                        {
+                            columns[columnCount] = ((ArchetypeStorage<T>*)storage)->getColumn();
+                            columnValues[columnCount++] = values.data();
+                        }
+                        else
+                        {
+                            storage->insertRange(first, count, values.data());
+                        }
+                    }(values),
+                    ...);
+            },
+            values);
+        archetypes.insertBatch(first, count, columnCount, columns, columnValues);
+
+        // The ticks are kept next to the values, so they can only be set once every value is in place.
+        (storages[getComponentID<ComponentTypes>()]->markAdded(first, count, tick), ...);
+
+        if (!queries.empty())
+        {
+            for (size_t i = 0; i < count; ++i)
+                updateQueries(first + static_cast<uint32_t>(i));
+        }
+
+        return first;
+    }
+
     template <typename T> size_t World::registerComponent()
     {
-        assert(entityData.size() == 0);
-        size_t component_id = getComponentID<T>();
+        size_t component_id = registry.add<T>();
         static_assert(std::is_same<T, typename T::Storage::Type>(),
                       "A component can't use a storage for a different component type!");
-        storages.push_back(new typename T::Storage());
+        auto* storage = new typename T::Storage();
+        if constexpr (isArchetypeStored<T>())
+            storage->bind(archetypes);
+        storages.push_back(storage);
         return component_id;
     }
 
@@ -120,10 +339,23 @@ namespace cubos::core::ecs
 
         size_t componentId = getComponentID<T>();
         Storage<T>* storage = (Storage<T>*)storages[componentId];
+        T* inserted = storage->insert(entityIndex, value);
+
         // Set the entity mask for this component
-        entityData[entityIndex * elementsPerEntity + 1 + componentId / 8] |= 1 << (componentId % 8);
+        uint32_t& word = entityData[entityIndex * elementsPerEntity + 1 + componentId / 32];
+        if ((word & (1u << (componentId % 32))) == 0)
+        {
+            word |= 1u << (componentId % 32);
+            storage->markAdded(entityIndex, 1, tick);
+            if (!queries.empty())
+                updateQueries(entityIndex);
+        }
+        else
+        {
+            storage->markChanged(entityIndex, tick);
+        }
 
-        return storage->insert(entityIndex, value);
+        return inserted;
     }
 
     template <typename... ComponentTypes> void World::addComponents(uint64_t entity, ComponentTypes... components)
@@ -138,7 +370,7 @@ namespace cubos::core::ecs
             return nullptr;
 
         size_t componentId = getComponentID<T>();
-        if ((entityData[entityIndex * elementsPerEntity + 1 + componentId / 8] & (1 << (componentId % 8))) == 0)
+        if ((entityData[entityIndex * elementsPerEntity + 1 + componentId / 32] & (1u << (componentId % 32))) == 0)
             return nullptr;
 
         Storage<T>* storage = (Storage<T>*)storages[componentId];
@@ -152,8 +384,14 @@ namespace cubos::core::ecs
             return;
 
         size_t componentId = getComponentID<T>();
+        uint32_t& word = entityData[entityIndex * elementsPerEntity + 1 + componentId / 32];
+        if ((word & (1u << (componentId % 32))) == 0)
+            return;
+
         ((Storage<T>*)storages[componentId])->erase(entityIndex);
-        entityData[entityIndex * elementsPerEntity + 1 + componentId / 8] ^= 1 << (componentId % 8);
+        word &= ~(1u << (componentId % 32));
+        if (!queries.empty())
+            updateQueries(entityIndex);
     }
 
     template <typename... ComponentTypes> void World::removeComponents(uint64_t entity)
@@ -161,6 +399,79 @@ namespace cubos::core::ecs
         ([&]() { removeComponent<ComponentTypes>(entity); }(), ...);
     }
 
+    template <typename T> void World::markChanged(uint64_t entity)
+    {
+        uint32_t entityIndex = (uint32_t)entity;
+        if (entity >> 32 != entityData[entityIndex * elementsPerEntity])
+            return;
+
+        size_t componentId = getComponentID<T>();
+        if ((entityData[entityIndex * elementsPerEntity + 1 + componentId / 32] & (1u << (componentId % 32))) != 0)
+            storages[componentId]->markChanged(entityIndex, tick);
+    }
+
+    template <typename T> void World::insertResource(T value)
+    {
+        size_t id = getResourceID<T>();
+        if (id >= resources.size())
+            resources.resize(id + 1);
+        resources[id] = std::make_unique<TypedResourceSlot<T>>(std::move(value));
+    }
+
+    template <typename T> void World::removeResource()
+    {
+        size_t id = getResourceID<T>();
+        if (id < resources.size())
+            resources[id].reset();
+    }
+
+    template <typename T> bool World::hasResource() const
+    {
+        size_t id = getResourceID<T>();
+        return id < resources.size() && resources[id] != nullptr;
+    }
+
+    template <typename T> ReadResource<T> World::read()
+    {
+        return ReadResource<T>(getResourceSlot<T>());
+    }
+
+    template <typename T> WriteResource<T> World::write()
+    {
+        return WriteResource<T>(getResourceSlot<T>());
+    }
+
+    template <typename T> TypedResourceSlot<T>& World::getResourceSlot()
+    {
+        if (!hasResource<T>())
+        {
+            logCritical("World::getResourceSlot() failed: no resource of type \"{}\" was inserted", typeid(T).name());
+            abort();
+        }
+
+        return *static_cast<TypedResourceSlot<T>*>(resources[getResourceID<T>()].get());
+    }
+
+    template <typename... ComponentTypes, typename F> void World::forEachChunk(F f)
+    {
+        static_assert((isArchetypeStored<ComponentTypes>() && ...),
+                      "Only components stored in an ArchetypeStorage can be iterated by chunk!");
+
+        size_t columns[] = {((ArchetypeStorage<ComponentTypes>*)storages[getComponentID<ComponentTypes>()])
+                                ->getColumn()...};
+        uint64_t mask = 0;
+        for (auto column : columns)
+            mask |= uint64_t(1) << column;
+
+        [&]<size_t... Is>(std::index_sequence<Is...>)
+        {
+            archetypes.forEachChunk(mask, [&](const ArchetypeTable::Chunk& chunk) {
+                f(chunk.count, chunk.entities, static_cast<ComponentTypes*>(chunk.column(columns[Is]))...);
+            });
+        }
+        (std::index_sequence_for<ComponentTypes...>());
+    }
+
 } // namespace cubos::core::ecs
 
 #endif // CUBOS_ECS_WORLD_HPP
@@ -2,27 +2,41 @@
 #define CUBOS_CORE_ECS_WORLD_VIEW_HPP
 
 #include <cubos/core/ecs/world.hpp>
+#include <cubos/core/ecs/access.hpp>
+#include <cubos/core/ecs/mask_matcher.hpp>
+#include <cubos/core/thread_pool.hpp>
+
+#include <algorithm>
+#include <tuple>
 
 namespace cubos::core::ecs
 {
 
     /// @brief WorldView is an iterator over the entities of a world
     /// that contain a certain set of components.
+    /// Instead of checking every entity of the world, the view only checks the smallest set of candidates it can find:
+    /// the packed entities of a storage which keeps them (such as SparseSetStorage) or, if any of the components is
+    /// stored in an ArchetypeStorage, the entities of the archetypes which contain them, visited in archetype order.
+    /// When no such set exists, the masks of all entities are scanned in bulk with matchMasks.
+    /// Component types may be wrapped in Read or Write to declare how they are accessed by forEachParallel, or in
+    /// Changed or Added to only match the entities whose component was changed or added after a given tick.
     /// @tparam ComponentTypes The set of component types to be iterated.
     template <typename... ComponentTypes> struct WorldView
     {
         World* world;
-        std::vector<uint8_t> mask;
+        ComponentMask mask{};
+        std::vector<uint32_t> entities; ///< Indices of the entities matched by the view.
 
-        WorldView(World& w);
+        /// @param w World to iterate.
+        /// @param since Tick after which components must have been changed or added to pass the Changed and Added
+        /// filters. By default, every component passes them.
+        WorldView(World& w, uint32_t since = 0);
 
         struct Iterator
         {
-            World* world;
-            size_t current;
-            std::vector<uint8_t>* mask;
+            const uint32_t* current;
 
-            Iterator(World* w, size_t index, std::vector<uint8_t>* m);
+            Iterator(const uint32_t* current);
 
             size_t operator*() const;
 
@@ -30,8 +44,6 @@ namespace cubos::core::ecs
 
             bool operator!=(const Iterator& other) const;
 
-            bool isValidID();
-
             Iterator& operator++();
         };
 
@@ -40,58 +52,135 @@ namespace cubos::core::ecs
         Iterator begin();
 
         Iterator end();
+
+        /// @brief Calls a function for each entity in the view, splitting them in chunks which run in parallel on a
+        /// thread pool. The function receives the entity and a reference to each component, which is const for
+        /// components declared with Read. Declaring conflicting accesses to the same component is a compile error.
+        /// The function must not add or remove entities or components.
+        /// @tparam F Function type.
+        /// @param pool Thread pool where the chunks are run.
+        /// @param f Function to call.
+        /// @param grain Maximum number of entities per chunk.
+        template <typename F> void forEachParallel(ThreadPool& pool, F f, size_t grain = 256);
     };
 
-    template <typename... ComponentTypes> WorldView<ComponentTypes...>::WorldView(World& w) : world(&w)
+    template <typename... ComponentTypes> WorldView<ComponentTypes...>::WorldView(World& w, uint32_t since) : world(&w)
     {
-        mask.resize(world->elementsPerEntity - 1);
-        size_t componentIds[] = {world->getComponentID<ComponentTypes>()...};
+        size_t componentIds[] = {world->getComponentID<AccessComponent<ComponentTypes>>()...};
         for (auto id : componentIds)
         {
-            mask[id / 32] |= 1 << (id % 32);
+            mask[id / 32] |= 1u << (id % 32);
+        }
+
+        // Iterate over the smallest set of candidates available: the packed indices of a storage, the entities in
+        // the archetypes which contain the archetype stored components, or, if neither is available, every entity.
+        const uint32_t* packed = nullptr;
+        size_t packedCount = SIZE_MAX;
+        for (auto id : componentIds)
+        {
+            const uint32_t* indices;
+            size_t count;
+            if (world->storages[id]->getPacked(indices, count) && count < packedCount)
+            {
+                packed = indices;
+                packedCount = count;
+            }
+        }
+
+        uint64_t columns = 0;
+        (
+            [&]() {
+                using Component = AccessComponent<ComponentTypes>;
+                if constexpr (World::isArchetypeStored<Component>())
+                {
+                    size_t id = world->getComponentID<Component>();
+                    columns |= uint64_t(1) << ((ArchetypeStorage<Component>*)world->storages[id])->getColumn();
+                }
+            }(),
+            ...);
+
+        size_t archetypeCount = SIZE_MAX;
+        if (columns != 0)
+        {
+            archetypeCount = 0;
+            world->archetypes.forEachChunk(columns,
+                                           [&](const ArchetypeTable::Chunk& chunk) { archetypeCount += chunk.count; });
+        }
+
+        if (packedCount != SIZE_MAX && packedCount <= archetypeCount)
+        {
+            entities.reserve(packedCount);
+            for (size_t i = 0; i < packedCount; ++i)
+            {
+                if (isValidIndex(packed[i]))
+                    entities.push_back(packed[i]);
+            }
+        }
+        else if (columns != 0)
+        {
+            entities.reserve(archetypeCount);
+            world->archetypes.forEachChunk(columns, [&](const ArchetypeTable::Chunk& chunk) {
+                for (size_t i = 0; i < chunk.count; ++i)
+                {
+                    if (isValidIndex(chunk.entities[i]))
+                        entities.push_back(chunk.entities[i]);
+                }
+            });
+        }
+        else if (world->nextEntityId > 0)
+        {
+            matchMasks(world->entityData.data(), world->elementsPerEntity, world->nextEntityId, mask.data(), entities);
+        }
+
+        // Filter out the entities whose components weren't touched since the given tick.
+        if constexpr (((AccessTraits<ComponentTypes>::Filter != TickFilter::None) || ...))
+        {
+            auto untouched = [&](uint32_t index) {
+                return (
+                    [&]() {
+                        IStorage* storage = world->storages[world->getComponentID<AccessComponent<ComponentTypes>>()];
+                        switch (AccessTraits<ComponentTypes>::Filter)
+                        {
+                        case TickFilter::Changed:
+                            return storage->getTicks(index).changed <= since;
+                        case TickFilter::Added:
+                            return storage->getTicks(index).added <= since;
+                        default:
+                            return false;
+                        }
+                    }() ||
+                    ...);
+            };
+            entities.erase(std::remove_if(entities.begin(), entities.end(), untouched), entities.end());
         }
     }
 
     template <typename... ComponentTypes>
-    WorldView<ComponentTypes...>::Iterator::Iterator(World* w, size_t index, std::vector<uint8_t>* m)
-        : world(w), current(index), mask(m)
+    WorldView<ComponentTypes...>::Iterator::Iterator(const uint32_t* current) : current(current)
     {
     }
 
     template <typename... ComponentTypes> size_t WorldView<ComponentTypes...>::Iterator::operator*() const
     {
-        return current;
+        return *current;
     }
 
     template <typename... ComponentTypes>
     bool WorldView<ComponentTypes...>::Iterator::operator==(const Iterator& other) const
     {
-        return current == other.current || current == world->nextEntityId;
+        return current == other.current;
     }
 
     template <typename... ComponentTypes>
     bool WorldView<ComponentTypes...>::Iterator::operator!=(const Iterator& other) const
     {
-        return current != other.current && current != world->nextEntityId;
-    }
-
-    template <typename... ComponentTypes> bool WorldView<ComponentTypes...>::Iterator::isValidID()
-    {
-        for (size_t i = 0; i < mask->size(); i++)
-        {
-            if ((mask->at(i) & world->entityData[current * world->elementsPerEntity + 1 + i]) != mask->at(i))
-                return false;
-        }
-        return true;
+        return current != other.current;
     }
 
     template <typename... ComponentTypes>
     typename WorldView<ComponentTypes...>::Iterator& WorldView<ComponentTypes...>::Iterator::operator++()
     {
-        do
-        {
-            current++;
-        } while (current < world->nextEntityId && !isValidID());
+        ++current;
         return *this;
     }
 
@@ -109,21 +198,44 @@ namespace cubos::core::ecs
     template <typename... ComponentTypes>
     typename WorldView<ComponentTypes...>::Iterator WorldView<ComponentTypes...>::begin()
     {
-        size_t firstIndex = 0;
-        while (firstIndex < world->nextEntityId && !isValidIndex(firstIndex))
-        {
-            firstIndex++;
-        }
-
-        Iterator it(world, firstIndex, &mask);
-        return it;
+        return Iterator(entities.data());
     }
 
     template <typename... ComponentTypes>
     typename WorldView<ComponentTypes...>::Iterator WorldView<ComponentTypes...>::end()
     {
-        Iterator it(world, world->nextEntityId, &mask);
-        return it;
+        return Iterator(entities.data() + entities.size());
+    }
+
+    template <typename... ComponentTypes>
+    template <typename F>
+    void WorldView<ComponentTypes...>::forEachParallel(ThreadPool& pool, F f, size_t grain)
+    {
+        static_assert(!hasConflictingAccess<ComponentTypes...>(),
+                      "A component can't be written while being accessed by another type in the same view!");
+
+        auto storages = std::make_tuple((Storage<AccessComponent<ComponentTypes>>*)
+                                            world->storages[world->getComponentID<AccessComponent<ComponentTypes>>()]...);
+        uint32_t tick = world->tick;
+
+        pool.parallelFor(entities.size(), grain, [&](size_t begin, size_t end) {
+            std::apply(
+                [&](auto*... storages) {
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        uint32_t index = entities[i];
+                        (
+                            [&]() {
+                                if constexpr (AccessTraits<ComponentTypes>::Writes)
+                                    storages->markChanged(index, tick);
+                            }(),
+                            ...);
+                        f(size_t(index),
+                          static_cast<typename AccessTraits<ComponentTypes>::Reference>(*storages->get(index))...);
+                    }
+                },
+                storages);
+        });
     }
 
 } // namespace cubos::core::ecs
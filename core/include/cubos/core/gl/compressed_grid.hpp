@@ -0,0 +1,114 @@
+#ifndef CUBOS_CORE_GL_COMPRESSED_GRID_HPP
+#define CUBOS_CORE_GL_COMPRESSED_GRID_HPP
+
+#include <cubos/core/gl/grid.hpp>
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cubos::core::gl
+{
+    /// Grid of voxels which uses less memory than Grid, with the same get and set semantics.
+    /// By default, voxels are stored as bit-packed indices into a palette of the materials used by the grid, with
+    /// 0, 1, 2, 4 or 8 bits per voxel, so that a grid with a single material takes no space per voxel. When the
+    /// palette overflows, the indices are widened, and once there are more than 256 materials the voxels store their
+    /// materials directly, with 16 bits each.
+    /// Grids which rarely change can be compacted into runs of voxels with the same material, which are decompressed
+    /// back into the palette representation on the next set.
+    /// Voxel indices are determined by the same formula as in Grid: x + y * size.x + z * size.x * size.y
+    class CompressedGrid final
+    {
+    public:
+        /// How the voxels are stored.
+        enum class Mode
+        {
+            Palette,  ///< Bit-packed indices into a palette.
+            RunLength ///< Runs of voxels with the same material.
+        };
+
+        // Default constructor.
+        CompressedGrid();
+
+        /// @param size The size of the grid.
+        CompressedGrid(const glm::uvec3& size);
+
+        /// @param grid The grid to compress.
+        CompressedGrid(const Grid& grid);
+
+        CompressedGrid(CompressedGrid&&) = default;
+        CompressedGrid& operator=(CompressedGrid&&) = default;
+        ~CompressedGrid() = default;
+
+        /// @return The size of the grid.
+        const glm::uvec3& getSize() const;
+
+        /// Clears the grid.
+        void clear();
+
+        /// @param position The position of the voxel.
+        /// @param mat The material index to set.
+        void set(const glm::ivec3& position, uint16_t mat);
+
+        /// @param position The position of the voxel.
+        /// @return The material index at a given position.
+        uint16_t get(const glm::ivec3& position) const;
+
+        /// Removes the materials which are no longer used from the palette, narrowing the indices if possible.
+        /// @param runLength Whether to store the grid as runs of voxels with the same material afterwards.
+        void compact(bool runLength = false);
+
+        /// @return A grid with the same voxels.
+        Grid decompress() const;
+
+        /// @return How the voxels are stored.
+        Mode getMode() const;
+
+        /// @return The number of bits used by each voxel in the palette mode.
+        uint8_t getBitsPerVoxel() const;
+
+        /// @return The number of bytes used to store the voxels.
+        size_t getMemoryUsage() const;
+
+    private:
+        /// A run of voxels with the same material.
+        struct Run
+        {
+            uint32_t end; ///< Index of the voxel after the last voxel of the run.
+            uint16_t mat; ///< The material index of the voxels.
+        };
+
+        /// @param index The index of the voxel.
+        /// @return The value stored for a voxel in the palette mode.
+        uint16_t getPacked(size_t index) const;
+
+        /// @param index The index of the voxel.
+        /// @param value The value to store for the voxel in the palette mode.
+        void setPacked(size_t index, uint16_t value);
+
+        /// Repacks the voxels with a different number of bits per voxel.
+        /// @param bits The new number of bits per voxel.
+        void repack(uint8_t bits);
+
+        /// @return The material index of each voxel.
+        std::vector<uint16_t> getMaterials() const;
+
+        /// Replaces every voxel, storing them in the palette mode with the smallest possible palette.
+        /// @param materials The material index of each voxel.
+        void assign(const std::vector<uint16_t>& materials);
+
+        /// @return The number of voxels in the grid.
+        size_t getVoxelCount() const;
+
+        glm::uvec3 size;               ///< The size of the grid.
+        Mode mode;                     ///< How the voxels are stored.
+        uint8_t bits;                  ///< Bits per voxel in the palette mode. With 16 bits, no palette is used.
+        std::vector<uint16_t> palette; ///< The materials of the grid, indexed by the packed values.
+        std::vector<uint64_t> data;    ///< Packed values, which never cross word boundaries.
+        std::vector<Run> runs;         ///< Runs of the voxels, in the run length mode.
+    };
+} // namespace cubos::core::gl
+
+#endif // CUBOS_CORE_GL_COMPRESSED_GRID_HPP
@@ -46,6 +46,16 @@ namespace cubos::core::gl
         /// @return The material index at a given position.
         uint16_t get(const glm::ivec3& position) const;
 
+        /// Gets the region which contains every voxel changed since the dirty region was last cleared, so that only
+        /// the affected part of the grid has to be triangulated again.
+        /// @param min Set to the minimum corner of the region.
+        /// @param max Set to the maximum corner of the region, exclusive.
+        /// @return Whether any voxel was changed.
+        bool getDirtyRegion(glm::uvec3& min, glm::uvec3& max) const;
+
+        /// Clears the dirty region.
+        void clearDirtyRegion();
+
         /// Serializes the grid.
         /// @param serializer The serializer to use.
         void serialize(memory::Serializer& serializer) const;
@@ -55,8 +65,15 @@ namespace cubos::core::gl
         void deserialize(memory::Deserializer& deserializer);
 
     private:
-        glm::uvec3 size;               ///< The size of the grid.
-        std::vector<uint16_t> indices; ///< The indices of the grid.
+        /// Extends the dirty region to contain a region.
+        /// @param min The minimum corner of the region.
+        /// @param max The maximum corner of the region, exclusive.
+        void markDirty(const glm::uvec3& min, const glm::uvec3& max);
+
+        glm::uvec3 size;                 ///< The size of the grid.
+        std::vector<uint16_t> indices;   ///< The indices of the grid.
+        glm::uvec3 dirtyMin = {0, 0, 0}; ///< The minimum corner of the dirty region.
+        glm::uvec3 dirtyMax = {0, 0, 0}; ///< The maximum corner of the dirty region, exclusive.
     };
 } // namespace cubos::core::gl
 
@@ -0,0 +1,106 @@
+#ifndef CUBOS_CORE_GL_LOD_HPP
+#define CUBOS_CORE_GL_LOD_HPP
+
+#include <cubos/core/gl/grid.hpp>
+#include <cubos/core/gl/sectioned_mesh.hpp>
+#include <cubos/core/gl/vertex.hpp>
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <future>
+#include <vector>
+
+namespace cubos::core
+{
+    class ThreadPool;
+}
+
+namespace cubos::core::gl
+{
+    /// The maximum number of detail levels of a grid: full resolution, and 2x, 4x and 8x downsampling.
+    static constexpr size_t MaxLodLevels = 4;
+
+    /// Downsamples a grid, replacing each block of voxels by a single voxel. The new voxel is empty if less than half
+    /// of the block is solid, and otherwise gets the most common material of the solid voxels of the block.
+    /// @param grid The grid to downsample.
+    /// @param factor The number of voxels on each side of a block.
+    /// @return The downsampled grid, with size rounded up to whole blocks.
+    Grid downsample(const Grid& grid, int factor);
+
+    /// Downsamples a region of a grid into a grid which was already downsampled, as in the function above, recomputing
+    /// only the blocks which overlap the region. The blocks which change are added to the dirty region of the result.
+    /// @param grid The grid to downsample.
+    /// @param factor The number of voxels on each side of a block.
+    /// @param result The downsampled grid, with size rounded up to whole blocks.
+    /// @param min The minimum corner of the region of the original grid.
+    /// @param max The maximum corner of the region of the original grid, exclusive.
+    void downsample(const Grid& grid, int factor, Grid& result, const glm::uvec3& min, const glm::uvec3& max);
+
+    /// Triangulates a single level of detail of a grid. Level N is the grid downsampled by a factor of 2^N, and its
+    /// mesh is scaled back up so that it covers the same space as the original grid.
+    /// @param grid The grid to triangulate.
+    /// @param level The level to triangulate, less than MaxLodLevels.
+    /// @param mesh The mesh of the level.
+    /// @param occlusion Whether to compute the ambient occlusion of each vertex.
+    void triangulateLod(const Grid& grid, size_t level, Mesh& mesh, bool occlusion = false);
+
+    /// Triangulates a grid at multiple levels of detail, as in triangulateLod.
+    /// @param grid The grid to triangulate.
+    /// @param levelCount The number of levels to generate, at most MaxLodLevels.
+    /// @param meshes The mesh of each level.
+    /// @param occlusion Whether to compute the ambient occlusion of each vertex.
+    void triangulateLods(const Grid& grid, size_t levelCount, std::vector<Mesh>& meshes, bool occlusion = false);
+
+    /// Triangulates a grid at multiple levels of detail asynchronously, on a thread pool.
+    /// The grid must not be modified or destroyed until the future is ready.
+    /// @param grid The grid to triangulate.
+    /// @param levelCount The number of levels to generate, at most MaxLodLevels.
+    /// @param pool The thread pool to use.
+    /// @param occlusion Whether to compute the ambient occlusion of each vertex.
+    /// @return The future meshes, one per level.
+    std::future<std::vector<Mesh>> triangulateLodsAsync(const Grid& grid, size_t levelCount, ThreadPool& pool,
+                                                        bool occlusion = false);
+
+    /// Selects the level of detail to draw something at. Each level is used up to twice the distance of the previous.
+    /// @param distance The distance from the camera.
+    /// @param lodDistance The distance up to which the full resolution level is used.
+    /// @param levelCount The number of available levels.
+    /// @return The level to draw.
+    size_t selectLod(float distance, float lodDistance, size_t levelCount);
+
+    /// Every level of detail of a grid, each split into sections as in SectionedMesh. When a few voxels of the grid
+    /// change, only the blocks of the downsampled grids which contain them are recomputed, and only the sections around
+    /// the blocks which actually changed are triangulated again.
+    class SectionedLods final
+    {
+    public:
+        SectionedLods() = default;
+        SectionedLods(SectionedLods&&) = default;
+        ~SectionedLods() = default;
+
+        /// Sets whether to compute the ambient occlusion of each vertex. Changing it makes the next update
+        /// triangulate every section of every level.
+        /// @param occlusion Whether to compute the ambient occlusion of each vertex.
+        void setOcclusion(bool occlusion);
+
+        /// Updates the levels affected by the voxels changed since the last update, and clears the dirty region of
+        /// the grid. If the size of the grid changed, every level is built again.
+        /// @param grid The grid to triangulate.
+        /// @return Whether any section was triangulated.
+        bool update(Grid& grid);
+
+        /// Joins the sections of each level into a single mesh per level, scaled like in triangulateLod.
+        /// @param meshes The mesh of each level, resized to MaxLodLevels.
+        void build(std::vector<Mesh>& meshes) const;
+
+    private:
+        std::array<SectionedMesh, MaxLodLevels> levels; ///< The sections of each level.
+        std::array<Grid, MaxLodLevels - 1> coarse;      ///< The downsampled grid of each level after the first.
+        glm::uvec3 size = {0, 0, 0};                    ///< The size of the grid the levels were built from.
+        bool occlusion = false;                         ///< Whether to compute the ambient occlusion of each vertex.
+    };
+} // namespace cubos::core::gl
+
+#endif // CUBOS_CORE_GL_LOD_HPP
@@ -0,0 +1,83 @@
+#ifndef CUBOS_CORE_GL_RAYCAST_HPP
+#define CUBOS_CORE_GL_RAYCAST_HPP
+
+#include <cubos/core/gl/grid.hpp>
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cubos::core::gl
+{
+    /// Describes where a ray hit a grid.
+    struct RaycastHit
+    {
+        glm::ivec3 position; ///< The position of the voxel hit.
+        glm::ivec3 normal;   ///< The normal of the face hit, or zero if the ray started inside a solid voxel.
+        uint16_t material;   ///< The material of the voxel hit.
+        float distance;      ///< The distance from the origin of the ray to the hit, in voxels.
+    };
+
+    /// Stores which blocks of 4x4x4 and 8x8x8 voxels of a grid have solid voxels, so that rays can skip the empty
+    /// blocks instead of visiting each of their voxels.
+    class OccupancyPyramid final
+    {
+    public:
+        /// The number of voxels on each side of the blocks of each level.
+        static constexpr int BlockSizes[] = {4, 8};
+
+        /// The number of levels of the pyramid.
+        static constexpr size_t LevelCount = sizeof(BlockSizes) / sizeof(BlockSizes[0]);
+
+        /// @param grid The grid to build the pyramid from.
+        OccupancyPyramid(const Grid& grid);
+
+        OccupancyPyramid(OccupancyPyramid&&) = default;
+        OccupancyPyramid& operator=(OccupancyPyramid&&) = default;
+        ~OccupancyPyramid() = default;
+
+        /// Updates the blocks which overlap a region of the grid, after its voxels changed. The size of the grid
+        /// must not have changed.
+        /// @param grid The grid the pyramid was built from.
+        /// @param min The minimum corner of the region.
+        /// @param max The maximum corner of the region, exclusive.
+        void update(const Grid& grid, const glm::uvec3& min, const glm::uvec3& max);
+
+        /// @param level The level of the block.
+        /// @param position The position of a voxel inside the grid.
+        /// @return Whether the block of the given level which contains the voxel has no solid voxels.
+        bool isBlockEmpty(size_t level, const glm::ivec3& position) const;
+
+    private:
+        glm::uvec3 size;                           ///< The size of the grid.
+        glm::uvec3 blocks[LevelCount];             ///< The number of blocks on each axis, on each level.
+        std::vector<uint8_t> occupied[LevelCount]; ///< Whether each block of each level has solid voxels.
+    };
+
+    /// Finds the first solid voxel of a grid hit by a ray, by walking through the voxels the ray crosses, in order
+    /// (Amanatides and Woo's 3D-DDA). Voxel (x, y, z) occupies the space from (x, y, z) to (x + 1, y + 1, z + 1).
+    /// @param grid The grid.
+    /// @param origin The origin of the ray, which may be outside of the grid.
+    /// @param direction The direction of the ray, which doesn't have to be normalized.
+    /// @param maxDistance The maximum distance, in voxels, which the ray travels.
+    /// @param hit Set to the description of the hit, if any.
+    /// @return Whether the ray hit a solid voxel.
+    bool raycast(const Grid& grid, const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+                 RaycastHit& hit);
+
+    /// Same as the other raycast overload, but skips the empty blocks of the grid, which is much faster for grids
+    /// with large empty regions.
+    /// @param grid The grid.
+    /// @param pyramid The occupancy pyramid of the grid, which must be up to date.
+    /// @param origin The origin of the ray, which may be outside of the grid.
+    /// @param direction The direction of the ray, which doesn't have to be normalized.
+    /// @param maxDistance The maximum distance, in voxels, which the ray travels.
+    /// @param hit Set to the description of the hit, if any.
+    /// @return Whether the ray hit a solid voxel.
+    bool raycast(const Grid& grid, const OccupancyPyramid& pyramid, const glm::vec3& origin, const glm::vec3& direction,
+                 float maxDistance, RaycastHit& hit);
+} // namespace cubos::core::gl
+
+#endif // CUBOS_CORE_GL_RAYCAST_HPP
@@ -0,0 +1,61 @@
+#ifndef CUBOS_CORE_GL_SECTIONED_MESH_HPP
+#define CUBOS_CORE_GL_SECTIONED_MESH_HPP
+
+#include <cubos/core/gl/grid.hpp>
+#include <cubos/core/gl/vertex.hpp>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace cubos::core::gl
+{
+    /// Mesh of a grid which is split into cubic sections, each triangulated separately, so that when a few voxels of
+    /// the grid change only the sections around them have to be triangulated again.
+    class SectionedMesh final
+    {
+    public:
+        /// The number of voxels on each side of a section.
+        static constexpr int SectionSize = 16;
+
+        SectionedMesh() = default;
+
+        /// @param occlusion Whether to compute the ambient occlusion of each vertex.
+        explicit SectionedMesh(bool occlusion);
+
+        SectionedMesh(SectionedMesh&&) = default;
+        SectionedMesh& operator=(SectionedMesh&&) = default;
+        ~SectionedMesh() = default;
+
+        /// Triangulates again the sections affected by the voxels changed since the last update, and clears the
+        /// dirty region of the grid. If the size of the grid changed, every section is triangulated.
+        /// @param grid The grid to triangulate.
+        /// @return Whether any section was triangulated.
+        bool update(Grid& grid);
+
+        /// Sets whether to compute the ambient occlusion of each vertex. Changing it makes the next update
+        /// triangulate every section.
+        /// @param occlusion Whether to compute the ambient occlusion of each vertex.
+        void setOcclusion(bool occlusion);
+
+        /// Joins the meshes of all sections into a single mesh.
+        /// @param mesh The mesh to write to.
+        void build(Mesh& mesh) const;
+
+        /// @return The number of sections of the mesh.
+        size_t getSectionCount() const;
+
+    private:
+        /// Triangulates a single section.
+        /// @param grid The grid to triangulate.
+        /// @param section The coordinates of the section.
+        void triangulateSection(const Grid& grid, const glm::uvec3& section);
+
+        glm::uvec3 size = {0, 0, 0};     ///< The size of the grid the mesh was built from.
+        glm::uvec3 sections = {0, 0, 0}; ///< The number of sections on each axis.
+        std::vector<Mesh> meshes;        ///< The mesh of each section.
+        bool occlusion = false;          ///< Whether to compute the ambient occlusion of each vertex.
+    };
+} // namespace cubos::core::gl
+
+#endif // CUBOS_CORE_GL_SECTIONED_MESH_HPP
@@ -6,6 +6,16 @@
 
 #include <glm/glm.hpp>
 
+#include <array>
+#include <functional>
+#include <future>
+#include <vector>
+
+namespace cubos::core
+{
+    class ThreadPool;
+} // namespace cubos::core
+
 namespace cubos::core::gl
 {
     class Grid;
@@ -19,6 +29,8 @@ namespace cubos::core::gl
 
         uint16_t material; ///< The material index on the palette.
 
+        uint8_t occlusion; ///< How occluded the vertex is by the voxels around it, from 0 (not at all) to 3.
+
         /// Serializes the grid.
         /// @param serializer The serializer to use.
         void serialize(memory::Serializer& serializer) const;
@@ -28,11 +40,104 @@ namespace cubos::core::gl
         void deserialize(memory::Deserializer& deserializer);
     };
 
+    /// Voxel vertex packed into 8 bytes, for meshes whose vertex coordinates are all at most 255, such as the meshes
+    /// of chunks. The normal is stored as the index of the face it points out of.
+    struct PackedVertex
+    {
+        uint8_t position[3]; ///< The position of the vertex.
+        uint8_t face;        ///< The face index (+X, -X, +Y, -Y, +Z, -Z) in bits 0-2, and the occlusion in bits 3-4.
+        uint16_t material;   ///< The material index on the palette.
+        uint16_t padding;    ///< Unused, keeps the vertices aligned to 4 bytes.
+    };
+
+    static_assert(sizeof(PackedVertex) == 8, "PackedVertex must be 8 bytes long");
+
+    /// The largest coordinate which fits in a packed vertex.
+    static constexpr uint32_t MaxPackedCoordinate = 255;
+
+    /// Packs vertices into the packed vertex format.
+    /// @param vertices The vertices to pack.
+    /// @param packed The packed vertices.
+    /// @return Whether all vertices fit in the packed format. If not, packed is left empty.
+    bool pack(const std::vector<Vertex>& vertices, std::vector<PackedVertex>& packed);
+
+    /// @param packed The packed vertex.
+    /// @return The vertex stored in a packed vertex.
+    Vertex unpack(const PackedVertex& packed);
+
+    // Represents an indexed mesh of voxel vertices
+    struct Mesh
+    {
+        std::vector<Vertex> vertices;  ///< The vertices of the mesh.
+        std::vector<uint32_t> indices; ///< The indices of the mesh.
+    };
+
     /// Triangulates a grid of voxels into an indexed mesh.
     /// @param grid The grid to triangulate.
     /// @param vertices The vertices of the mesh.
     /// @param indices The indices of the mesh.
     void triangulate(const Grid& grid, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+    /// Triangulates the faces of the voxels inside a region of a grid into an indexed mesh. Faces are only merged
+    /// inside the region, but voxels outside it are taken into account, so that the meshes of adjacent regions fit
+    /// together without hidden faces.
+    /// @param grid The grid to triangulate.
+    /// @param min The minimum corner of the region.
+    /// @param max The maximum corner of the region, exclusive.
+    /// @param vertices The vertices of the mesh.
+    /// @param indices The indices of the mesh.
+    /// @param occlusion Whether to compute the ambient occlusion of each vertex from the voxels around it. Quads are
+    /// only merged if their occlusion matches, so meshes with occlusion have more triangles.
+    void triangulate(const Grid& grid, const glm::uvec3& min, const glm::uvec3& max, std::vector<Vertex>& vertices,
+                     std::vector<uint32_t>& indices, bool occlusion = false);
+
+    /// Gets the material of a voxel outside of the grid being triangulated, in the coordinates of that grid.
+    using VoxelSampler = std::function<uint16_t(const glm::ivec3& position)>;
+
+    /// Triangulates a grid of voxels which is part of a larger world into an indexed mesh. Faces against solid voxels
+    /// outside of the grid are culled, so that no hidden faces are generated at the borders between chunks.
+    /// @param grid The grid to triangulate.
+    /// @param outside Called to get the voxels next to the grid.
+    /// @param vertices The vertices of the mesh.
+    /// @param indices The indices of the mesh.
+    /// @param occlusion Whether to compute the ambient occlusion of each vertex, as in the region overload.
+    void triangulate(const Grid& grid, const VoxelSampler& outside, std::vector<Vertex>& vertices,
+                     std::vector<uint32_t>& indices, bool occlusion = false);
+
+    /// Triangulates a grid of voxels into an indexed mesh, culling the faces against its neighbouring grids.
+    /// Voxels diagonal to the grid are considered empty when computing the occlusion.
+    /// @param grid The grid to triangulate.
+    /// @param neighbours The grids next to each face of the grid (+X, -X, +Y, -Y, +Z, -Z), or nullptr if empty.
+    /// @param vertices The vertices of the mesh.
+    /// @param indices The indices of the mesh.
+    /// @param occlusion Whether to compute the ambient occlusion of each vertex, as in the region overload.
+    void triangulate(const Grid& grid, const std::array<const Grid*, 6>& neighbours, std::vector<Vertex>& vertices,
+                     std::vector<uint32_t>& indices, bool occlusion = false);
+
+    /// Triangulates a grid of voxels into an indexed mesh, producing the same quads as triangulate, but faster.
+    /// The voxels along each axis are packed into 64 bit occupancy columns, the exposed faces of a whole column are
+    /// found with a couple of shifts and ANDs, and the quads are merged from per-material bitmasks of each slice.
+    /// The quads may be emitted in a different order than by triangulate. Grids with more than 64 voxels along any
+    /// axis don't fit in the bitmasks, and fall back to triangulate.
+    /// @param grid The grid to triangulate.
+    /// @param vertices The vertices of the mesh.
+    /// @param indices The indices of the mesh.
+    void triangulateBinary(const Grid& grid, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+    /// Triangulates a grid of voxels into an indexed mesh on a thread pool, splitting the work by face direction and
+    /// by ranges of slices, and waits for it to finish. The calling thread also triangulates while waiting.
+    /// The resulting mesh is the same as the one produced on a single thread.
+    /// @param grid The grid to triangulate.
+    /// @param vertices The vertices of the mesh.
+    /// @param indices The indices of the mesh.
+    /// @param pool The thread pool to use.
+    void triangulate(const Grid& grid, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, ThreadPool& pool);
+
+    /// Triangulates a grid of voxels into an indexed mesh on a thread pool, without waiting for it to finish.
+    /// @param grid The grid to triangulate, which must not be changed or destroyed until the mesh is ready.
+    /// @param pool The thread pool to use.
+    /// @return The future mesh.
+    std::future<Mesh> triangulateAsync(const Grid& grid, ThreadPool& pool);
 } // namespace cubos::core::gl
 
 #endif // CUBOS_CORE_GL_VERTEX_HPP
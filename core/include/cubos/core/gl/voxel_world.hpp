@@ -0,0 +1,109 @@
+#ifndef CUBOS_CORE_GL_VOXEL_WORLD_HPP
+#define CUBOS_CORE_GL_VOXEL_WORLD_HPP
+
+#include <cubos/core/gl/grid.hpp>
+#include <cubos/core/gl/vertex.hpp>
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+
+namespace cubos::core::gl
+{
+    /// Unbounded voxel container made of fixed-size chunks, each of which is a Grid of ChunkSize voxels on each side.
+    /// Chunks are kept in a hash map indexed by chunk coordinates, so finding the chunk of a voxel takes constant
+    /// time. Chunks are only allocated when a non-empty voxel is set in them, and freed once all of their voxels are
+    /// empty again, so empty space costs no memory.
+    /// To keep memory bounded as the camera moves, chunks far away from it can be evicted, and later inserted back.
+    class VoxelWorld final
+    {
+    public:
+        /// Number of voxels on each side of a chunk.
+        static constexpr int ChunkSize = 32;
+
+        VoxelWorld() = default;
+        VoxelWorld(VoxelWorld&&) = default;
+        ~VoxelWorld() = default;
+
+        /// @param position The position of the voxel.
+        /// @return The material index at a given position, or 0 if its chunk isn't allocated.
+        uint16_t get(const glm::ivec3& position) const;
+
+        /// Sets a voxel, allocating its chunk if necessary. Setting the last non-empty voxel of a chunk to 0 frees
+        /// the chunk.
+        /// @param position The position of the voxel.
+        /// @param mat The material index to set.
+        void set(const glm::ivec3& position, uint16_t mat);
+
+        /// @param chunk The coordinates of the chunk.
+        /// @return The grid of the chunk, or nullptr if it isn't allocated.
+        const Grid* getChunk(const glm::ivec3& chunk) const;
+
+        /// Inserts a chunk, such as one which was evicted before, replacing the previous one if it exists.
+        /// Chunks without non-empty voxels aren't inserted.
+        /// @param chunk The coordinates of the chunk.
+        /// @param grid The voxels of the chunk, which must be a grid with ChunkSize voxels on each side.
+        void insertChunk(const glm::ivec3& chunk, Grid&& grid);
+
+        /// Frees a chunk, if it's allocated.
+        /// @param chunk The coordinates of the chunk.
+        void removeChunk(const glm::ivec3& chunk);
+
+        /// Evicts every chunk farther than a given distance, in chunks along any axis, from a center chunk.
+        /// @param center The coordinates of the center chunk, usually the chunk of the camera.
+        /// @param radius The maximum distance, in chunks, of the chunks to keep.
+        /// @param onEvict Called with the coordinates and grid of each chunk before it's evicted, so that it can be
+        /// saved and inserted back later.
+        /// @return The number of evicted chunks.
+        size_t evict(const glm::ivec3& center, int radius,
+                     const std::function<void(const glm::ivec3&, Grid&&)>& onEvict = {});
+
+        /// Calls a function for each allocated chunk, in no specific order.
+        /// @param f Function called with the coordinates and grid of each chunk.
+        void forEachChunk(const std::function<void(const glm::ivec3&, const Grid&)>& f) const;
+
+        /// @return The number of allocated chunks.
+        size_t getChunkCount() const;
+
+        /// Triangulates a chunk, culling the faces hidden by the voxels of the chunks around it. The positions of the
+        /// vertices are relative to the chunk.
+        /// @param chunk The coordinates of the chunk.
+        /// @param vertices The vertices of the mesh.
+        /// @param indices The indices of the mesh.
+        /// @param occlusion Whether to compute the ambient occlusion of each vertex.
+        void triangulateChunk(const glm::ivec3& chunk, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+                              bool occlusion = false) const;
+
+        /// Frees every chunk.
+        void clear();
+
+        /// @param position The position of a voxel.
+        /// @return The coordinates of the chunk which contains the voxel.
+        static glm::ivec3 toChunk(const glm::ivec3& position);
+
+        /// @param position The position of a voxel.
+        /// @return The position of the voxel inside its chunk.
+        static glm::ivec3 toLocal(const glm::ivec3& position);
+
+    private:
+        /// A chunk and the number of its voxels which aren't empty.
+        struct Chunk
+        {
+            Grid grid;           ///< The voxels of the chunk.
+            uint32_t solidCount; ///< The number of non-empty voxels.
+        };
+
+        /// Hashes chunk coordinates.
+        struct ChunkHash
+        {
+            size_t operator()(const glm::ivec3& chunk) const;
+        };
+
+        std::unordered_map<glm::ivec3, Chunk, ChunkHash> chunks; ///< The allocated chunks.
+    };
+} // namespace cubos::core::gl
+
+#endif // CUBOS_CORE_GL_VOXEL_WORLD_HPP
@@ -0,0 +1,56 @@
+#ifndef CUBOS_CORE_MEMORY_BINARY_DESERIALIZER_HPP
+#define CUBOS_CORE_MEMORY_BINARY_DESERIALIZER_HPP
+
+#include <cubos/core/memory/deserializer.hpp>
+
+namespace cubos::core::memory
+{
+    /// Implementation of the abstract Deserializer class for deserializing the binary format written by
+    /// BinarySerializer. Reads past the end of the stream, and lengths or counts larger than the bytes left in it, make
+    /// the deserializer fail: the value being read is zeroed or left empty, and so is every value read after it.
+    class BinaryDeserializer : public Deserializer
+    {
+    public:
+        /// @param stream The stream to deserialize from.
+        BinaryDeserializer(Stream& stream);
+
+        // Implement interface methods.
+
+        virtual void read(int8_t& value) override;
+        virtual void read(int16_t& value) override;
+        virtual void read(int32_t& value) override;
+        virtual void read(int64_t& value) override;
+        virtual void read(uint8_t& value) override;
+        virtual void read(uint16_t& value) override;
+        virtual void read(uint32_t& value) override;
+        virtual void read(uint64_t& value) override;
+        virtual void read(float& value) override;
+        virtual void read(double& value) override;
+        virtual void read(bool& value) override;
+        virtual void read(std::string& value) override;
+        virtual void beginObject() override;
+        virtual void endObject() override;
+        virtual size_t beginArray() override;
+        virtual void endArray() override;
+        virtual size_t beginDictionary() override;
+        virtual void endDictionary() override;
+
+        /// @return True if a read failed, in which case the values read since then aren't valid.
+        bool failed() const;
+
+    private:
+        /// Reads a value written as raw little endian bytes.
+        /// @tparam T Type of the value.
+        /// @param value The value to deserialize.
+        template <typename T> void readScalar(T& value);
+
+        /// Reads a length or count, and fails if it is larger than the number of bytes left in the stream.
+        /// @return The length or count, or 0 if the deserializer failed.
+        size_t readLength();
+
+        size_t end;     ///< Position of the end of the stream.
+        bool hasFailed; ///< Whether a read has failed.
+    };
+} // namespace cubos::core::memory
+
+#endif // CUBOS_CORE_MEMORY_BINARY_DESERIALIZER_HPP
@@ -0,0 +1,40 @@
+#ifndef CUBOS_CORE_MEMORY_BINARY_SERIALIZER_HPP
+#define CUBOS_CORE_MEMORY_BINARY_SERIALIZER_HPP
+
+#include <cubos/core/memory/serializer.hpp>
+
+namespace cubos::core::memory
+{
+    /// Implementation of the abstract Serializer class for serializing to a compact binary format.
+    /// Values are written in little endian, without names, and arrays, dictionaries and strings are prefixed with
+    /// their length. Meant to be read back by BinaryDeserializer.
+    class BinarySerializer : public Serializer
+    {
+    public:
+        /// @param stream The stream to serialize to.
+        BinarySerializer(Stream& stream);
+
+        // Implement interface methods.
+
+        virtual void write(int8_t value, const char* name) override;
+        virtual void write(int16_t value, const char* name) override;
+        virtual void write(int32_t value, const char* name) override;
+        virtual void write(int64_t value, const char* name) override;
+        virtual void write(uint8_t value, const char* name) override;
+        virtual void write(uint16_t value, const char* name) override;
+        virtual void write(uint32_t value, const char* name) override;
+        virtual void write(uint64_t value, const char* name) override;
+        virtual void write(float value, const char* name) override;
+        virtual void write(double value, const char* name) override;
+        virtual void write(bool value, const char* name) override;
+        virtual void write(const char* value, const char* name) override;
+        virtual void beginObject(const char* name) override;
+        virtual void endObject() override;
+        virtual void beginArray(size_t length, const char* name) override;
+        virtual void endArray() override;
+        virtual void beginDictionary(size_t length, const char* name) override;
+        virtual void endDictionary() override;
+    };
+} // namespace cubos::core::memory
+
+#endif // CUBOS_CORE_MEMORY_BINARY_SERIALIZER_HPP
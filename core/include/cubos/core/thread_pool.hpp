@@ -0,0 +1,75 @@
+#ifndef CUBOS_CORE_THREAD_POOL_HPP
+#define CUBOS_CORE_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cubos::core
+{
+    /// Pool of worker threads which execute tasks.
+    /// Each worker has its own task queue: tasks added from a worker go to the front of its own queue, and workers
+    /// with no tasks left steal them from the back of the queues of other workers.
+    class ThreadPool
+    {
+    public:
+        using Task = std::function<void()>;
+
+        /// @param threadCount The number of worker threads to create.
+        ThreadPool(size_t threadCount = std::thread::hardware_concurrency());
+
+        /// Waits for the pending tasks to finish and stops the worker threads.
+        ~ThreadPool();
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /// @return The number of worker threads.
+        size_t getThreadCount() const;
+
+        /// Adds a task to be executed by the pool.
+        /// @param task The task to execute.
+        void addTask(Task task);
+
+        /// Executes one pending task on the calling thread, if there's any.
+        /// Used by threads which are waiting for tasks to finish, so that they help instead of blocking.
+        /// @return True if a task was executed, false otherwise.
+        bool runPendingTask();
+
+        /// Splits the range [0, count) in chunks of at most grain elements, calls a function for each chunk on the
+        /// pool and waits for all of them to finish. The calling thread also executes tasks while waiting.
+        /// @param count The number of elements in the range.
+        /// @param grain The maximum number of elements per chunk.
+        /// @param f The function to call, with the beginning and end of each chunk.
+        void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& f);
+
+    private:
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        /// Pops a task from the queue of a worker or, if it's empty, steals one from the other workers.
+        /// @param index The index of the worker.
+        /// @param task Set to the task popped.
+        /// @return True if a task was popped, false otherwise.
+        bool popTask(size_t index, Task& task);
+
+        void workerLoop(size_t index);
+
+        std::vector<std::unique_ptr<Queue>> queues; ///< Task queue of each worker.
+        std::vector<std::thread> threads;           ///< Worker threads.
+        std::mutex sleepMutex;                      ///< Mutex used by workers waiting for tasks.
+        std::condition_variable wakeUp;             ///< Notified when new tasks are added or the pool stops.
+        std::atomic<size_t> pending;                ///< Number of tasks in the queues.
+        std::atomic<size_t> nextQueue;              ///< Queue where the next task from outside the pool goes.
+        bool stopping;                              ///< Whether the workers should stop.
+    };
+} // namespace cubos::core
+
+#endif // CUBOS_CORE_THREAD_POOL_HPP
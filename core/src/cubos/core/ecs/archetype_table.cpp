@@ -0,0 +1,366 @@
+#include <cubos/core/ecs/archetype_table.hpp>
+#include <cubos/core/log.hpp>
+
+#include <bit>
+#include <cassert>
+#include <cstdlib>
+
+using namespace cubos::core::ecs;
+
+/// Alignment of the memory allocated for each chunk.
+static constexpr size_t ChunkAlignment = 64;
+
+void* ArchetypeTable::Chunk::column(size_t column) const
+{
+    auto* archetype = static_cast<const Archetype*>(this->archetype);
+    return this->data + archetype->offsets[archetype->indexOf(column)];
+}
+
+size_t ArchetypeTable::Archetype::indexOf(size_t column) const
+{
+    assert(this->mask & (uint64_t(1) << column));
+    return static_cast<size_t>(std::popcount(this->mask & ((uint64_t(1) << column) - 1)));
+}
+
+ArchetypeTable::~ArchetypeTable()
+{
+    this->clear();
+}
+
+size_t ArchetypeTable::registerColumn(const ColumnInfo& info)
+{
+    // Archetypes are keyed by a 64 bit mask of their columns, and chunks are only aligned to ChunkAlignment, so
+    // going past either limit would silently corrupt the table.
+    if (this->columnInfos.size() >= MaxColumns)
+    {
+        logCritical("ArchetypeTable::registerColumn() failed: more than {} archetype stored component types were "
+                    "registered",
+                    MaxColumns);
+        abort();
+    }
+
+    if (info.alignment > ChunkAlignment)
+    {
+        logCritical("ArchetypeTable::registerColumn() failed: alignment {} is over the chunk alignment of {}",
+                    info.alignment, ChunkAlignment);
+        abort();
+    }
+
+    this->columnInfos.push_back(info);
+    return this->columnInfos.size() - 1;
+}
+
+void* ArchetypeTable::insert(uint32_t entity, size_t column, void* value)
+{
+    if (entity >= this->locations.size())
+        this->locations.resize(entity + 1);
+
+    auto& info = this->columnInfos[column];
+    uint64_t bit = uint64_t(1) << column;
+    uint64_t mask = 0;
+
+    if (this->locations[entity].archetype != NoArchetype)
+    {
+        auto& archetype = *this->archetypes[this->locations[entity].archetype];
+        if (archetype.mask & bit)
+        {
+            // The entity already has this column, so the value is replaced in place.
+            void* ptr = this->at(archetype, this->locations[entity].row, archetype.indexOf(column));
+            info.destroy(ptr);
+            info.moveConstruct(ptr, value);
+            return ptr;
+        }
+
+        mask = archetype.mask;
+    }
+
+    this->migrate(entity, mask | bit, MaxColumns);
+    auto& location = this->locations[entity];
+    auto& archetype = *this->archetypes[location.archetype];
+    void* ptr = this->at(archetype, location.row, archetype.indexOf(column));
+    info.moveConstruct(ptr, value);
+    *this->ticksAt(archetype, location.row, archetype.indexOf(column)) = {};
+    return ptr;
+}
+
+void ArchetypeTable::insertBatch(uint32_t first, size_t count, size_t columnCount, const size_t* columns,
+                                 void* const* values)
+{
+    if (count == 0 || columnCount == 0)
+        return;
+
+    if (first + count > this->locations.size())
+        this->locations.resize(first + count);
+
+    uint64_t mask = 0;
+    for (size_t c = 0; c < columnCount; ++c)
+        mask |= uint64_t(1) << columns[c];
+    uint32_t id = this->findOrCreate(mask);
+    auto& archetype = *this->archetypes[id];
+    archetype.entities.reserve(archetype.entities.size() + count);
+
+    for (size_t e = 0; e < count; ++e)
+    {
+        uint32_t entity = first + static_cast<uint32_t>(e);
+        assert(this->locations[entity].archetype == NoArchetype);
+        size_t row = this->pushRow(archetype, entity);
+        for (size_t c = 0; c < columnCount; ++c)
+        {
+            auto& info = this->columnInfos[columns[c]];
+            size_t index = archetype.indexOf(columns[c]);
+            info.moveConstruct(this->at(archetype, row, index), static_cast<std::byte*>(values[c]) + e * info.size);
+            *this->ticksAt(archetype, row, index) = {};
+        }
+        this->locations[entity] = {id, static_cast<uint32_t>(row)};
+    }
+}
+
+void ArchetypeTable::insertRows(size_t columnCount, const size_t* columns, const uint32_t* const* entities,
+                                const size_t* counts, void* const* values)
+{
+    // The entity lists are merged, and each entity is pushed to the archetype made of the columns which list it.
+    size_t size = this->locations.size();
+    for (size_t c = 0; c < columnCount; ++c)
+    {
+        if (counts[c] > 0)
+            size = std::max(size, static_cast<size_t>(entities[c][counts[c] - 1]) + 1);
+    }
+    this->locations.resize(size);
+
+    std::vector<size_t> cursors(columnCount, 0);
+    uint64_t lastMask = 0;
+    uint32_t id = NoArchetype;
+    while (true)
+    {
+        uint32_t entity = UINT32_MAX;
+        for (size_t c = 0; c < columnCount; ++c)
+        {
+            if (cursors[c] < counts[c])
+                entity = std::min(entity, entities[c][cursors[c]]);
+        }
+
+        if (entity == UINT32_MAX)
+            break;
+
+        uint64_t mask = 0;
+        for (size_t c = 0; c < columnCount; ++c)
+        {
+            if (cursors[c] < counts[c] && entities[c][cursors[c]] == entity)
+                mask |= uint64_t(1) << columns[c];
+        }
+
+        // Consecutive entities usually share their archetype, so the last one found is reused.
+        if (id == NoArchetype || mask != lastMask)
+        {
+            id = this->findOrCreate(mask);
+            lastMask = mask;
+        }
+
+        auto& archetype = *this->archetypes[id];
+        assert(this->locations[entity].archetype == NoArchetype);
+        size_t row = this->pushRow(archetype, entity);
+        for (size_t c = 0; c < columnCount; ++c)
+        {
+            if (cursors[c] >= counts[c] || entities[c][cursors[c]] != entity)
+                continue;
+
+            auto& info = this->columnInfos[columns[c]];
+            size_t index = archetype.indexOf(columns[c]);
+            info.moveConstruct(this->at(archetype, row, index),
+                               static_cast<std::byte*>(values[c]) + cursors[c] * info.size);
+            *this->ticksAt(archetype, row, index) = {};
+            cursors[c] += 1;
+        }
+        this->locations[entity] = {id, static_cast<uint32_t>(row)};
+    }
+}
+
+void* ArchetypeTable::get(uint32_t entity, size_t column)
+{
+    if (entity >= this->locations.size() || this->locations[entity].archetype == NoArchetype)
+        return nullptr;
+
+    auto& location = this->locations[entity];
+    auto& archetype = *this->archetypes[location.archetype];
+    if ((archetype.mask & (uint64_t(1) << column)) == 0)
+        return nullptr;
+    return this->at(archetype, location.row, archetype.indexOf(column));
+}
+
+ComponentTicks* ArchetypeTable::getTicks(uint32_t entity, size_t column)
+{
+    if (entity >= this->locations.size() || this->locations[entity].archetype == NoArchetype)
+        return nullptr;
+
+    auto& location = this->locations[entity];
+    auto& archetype = *this->archetypes[location.archetype];
+    if ((archetype.mask & (uint64_t(1) << column)) == 0)
+        return nullptr;
+    return this->ticksAt(archetype, location.row, archetype.indexOf(column));
+}
+
+void ArchetypeTable::erase(uint32_t entity, size_t column)
+{
+    if (entity >= this->locations.size() || this->locations[entity].archetype == NoArchetype)
+        return;
+
+    uint64_t mask = this->archetypes[this->locations[entity].archetype]->mask;
+    if ((mask & (uint64_t(1) << column)) == 0)
+        return;
+
+    this->migrate(entity, mask & ~(uint64_t(1) << column), column);
+}
+
+void ArchetypeTable::clear()
+{
+    for (auto& archetype : this->archetypes)
+    {
+        for (size_t row = 0; row < archetype->entities.size(); ++row)
+            for (size_t i = 0; i < archetype->columns.size(); ++i)
+                this->columnInfos[archetype->columns[i]].destroy(this->at(*archetype, row, i));
+
+        for (auto* chunk : archetype->chunks)
+            ::operator delete(chunk, std::align_val_t(ChunkAlignment));
+        archetype->chunks.clear();
+        archetype->entities.clear();
+    }
+
+    this->locations.clear();
+}
+
+uint32_t ArchetypeTable::findOrCreate(uint64_t mask)
+{
+    auto it = this->archetypeIds.find(mask);
+    if (it != this->archetypeIds.end())
+        return it->second;
+
+    auto archetype = std::make_unique<Archetype>();
+    archetype->mask = mask;
+
+    size_t rowSize = 0;
+    for (size_t column = 0; column < this->columnInfos.size(); ++column)
+    {
+        if (mask & (uint64_t(1) << column))
+        {
+            archetype->columns.push_back(column);
+            rowSize += this->columnInfos[column].size + sizeof(ComponentTicks);
+        }
+    }
+    archetype->offsets.resize(archetype->columns.size());
+    archetype->tickOffsets.resize(archetype->columns.size());
+
+    // Find the largest number of rows whose column arrays, after padding, still fit in a chunk.
+    archetype->capacity = std::max(ChunkSize / rowSize, size_t(1));
+    while (true)
+    {
+        size_t offset = 0;
+        for (size_t i = 0; i < archetype->columns.size(); ++i)
+        {
+            auto& info = this->columnInfos[archetype->columns[i]];
+            offset = (offset + info.alignment - 1) / info.alignment * info.alignment;
+            archetype->offsets[i] = offset;
+            offset += info.size * archetype->capacity;
+            offset = (offset + alignof(ComponentTicks) - 1) / alignof(ComponentTicks) * alignof(ComponentTicks);
+            archetype->tickOffsets[i] = offset;
+            offset += sizeof(ComponentTicks) * archetype->capacity;
+        }
+
+        if (offset <= ChunkSize || archetype->capacity == 1)
+        {
+            archetype->chunkBytes = std::max(offset, ChunkSize);
+            break;
+        }
+
+        archetype->capacity -= 1;
+    }
+
+    uint32_t id = static_cast<uint32_t>(this->archetypes.size());
+    this->archetypes.push_back(std::move(archetype));
+    this->archetypeIds.emplace(mask, id);
+    return id;
+}
+
+void* ArchetypeTable::at(Archetype& archetype, size_t row, size_t index)
+{
+    return archetype.chunks[row / archetype.capacity] + archetype.offsets[index] +
+           (row % archetype.capacity) * this->columnInfos[archetype.columns[index]].size;
+}
+
+ComponentTicks* ArchetypeTable::ticksAt(Archetype& archetype, size_t row, size_t index)
+{
+    return reinterpret_cast<ComponentTicks*>(archetype.chunks[row / archetype.capacity] +
+                                             archetype.tickOffsets[index]) +
+           row % archetype.capacity;
+}
+
+size_t ArchetypeTable::pushRow(Archetype& archetype, uint32_t entity)
+{
+    if (archetype.entities.size() == archetype.chunks.size() * archetype.capacity)
+    {
+        archetype.chunks.push_back(
+            static_cast<std::byte*>(::operator new(archetype.chunkBytes, std::align_val_t(ChunkAlignment))));
+    }
+
+    archetype.entities.push_back(entity);
+    return archetype.entities.size() - 1;
+}
+
+void ArchetypeTable::popRow(Archetype& archetype, size_t row)
+{
+    // The values on the row must have already been moved out or destroyed.
+    size_t last = archetype.entities.size() - 1;
+    if (row != last)
+    {
+        for (size_t i = 0; i < archetype.columns.size(); ++i)
+        {
+            auto& info = this->columnInfos[archetype.columns[i]];
+            info.moveConstruct(this->at(archetype, row, i), this->at(archetype, last, i));
+            info.destroy(this->at(archetype, last, i));
+            *this->ticksAt(archetype, row, i) = *this->ticksAt(archetype, last, i);
+        }
+
+        archetype.entities[row] = archetype.entities[last];
+        this->locations[archetype.entities[row]].row = static_cast<uint32_t>(row);
+    }
+
+    archetype.entities.pop_back();
+
+    // Free the last chunk as soon as it becomes empty.
+    if (archetype.entities.size() == (archetype.chunks.size() - 1) * archetype.capacity)
+    {
+        ::operator delete(archetype.chunks.back(), std::align_val_t(ChunkAlignment));
+        archetype.chunks.pop_back();
+    }
+}
+
+void ArchetypeTable::migrate(uint32_t entity, uint64_t mask, size_t erased)
+{
+    auto& location = this->locations[entity];
+    uint32_t dstId = mask == 0 ? NoArchetype : this->findOrCreate(mask);
+    size_t dstRow = 0;
+    if (dstId != NoArchetype)
+        dstRow = this->pushRow(*this->archetypes[dstId], entity);
+
+    if (location.archetype != NoArchetype)
+    {
+        auto& src = *this->archetypes[location.archetype];
+        for (size_t i = 0; i < src.columns.size(); ++i)
+        {
+            auto& info = this->columnInfos[src.columns[i]];
+            void* value = this->at(src, location.row, i);
+            if (src.columns[i] != erased)
+            {
+                auto& dst = *this->archetypes[dstId];
+                size_t index = dst.indexOf(src.columns[i]);
+                info.moveConstruct(this->at(dst, dstRow, index), value);
+                *this->ticksAt(dst, dstRow, index) = *this->ticksAt(src, location.row, i);
+            }
+            info.destroy(value);
+        }
+
+        this->popRow(src, location.row);
+    }
+
+    location.archetype = dstId;
+    location.row = static_cast<uint32_t>(dstRow);
+}
@@ -0,0 +1,99 @@
+#include <cubos/core/ecs/commands.hpp>
+
+#include <algorithm>
+
+using namespace cubos::core::ecs;
+
+/// Size of the blocks allocated by the arenas of the buffers, unless a single command needs more.
+static constexpr size_t BlockSize = 64 * 1024;
+
+/// Used to give each buffer a unique identifier, which is never reused, unlike addresses.
+static std::atomic<uint64_t> nextCommandsId = 1;
+
+Commands::Commands(World& world)
+    : world(world), id(nextCommandsId.fetch_add(1))
+{
+}
+
+Commands::~Commands()
+{
+    for (auto& [thread, buffer] : this->buffers)
+        buffer->flush(nullptr);
+}
+
+void Commands::remove(uint64_t entity)
+{
+    this->push([entity](World& world) { world.remove(entity); });
+}
+
+void Commands::apply()
+{
+    // Create all of the reserved entities at once, before any command which may refer to them.
+    this->world.createReserved();
+
+    for (auto& [thread, buffer] : this->buffers)
+        buffer->flush(&this->world);
+}
+
+Commands::Buffer& Commands::getBuffer()
+{
+    // Cache the buffer of the last command buffer used by this thread, to avoid locking on every command.
+    thread_local struct
+    {
+        uint64_t id = 0;
+        Buffer* buffer = nullptr;
+    } cache;
+
+    if (cache.id != this->id)
+    {
+        std::lock_guard lock(this->mutex);
+        auto& buffer = this->buffers[std::this_thread::get_id()];
+        if (!buffer)
+            buffer = std::make_unique<Buffer>();
+        cache.id = this->id;
+        cache.buffer = buffer.get();
+    }
+
+    return *cache.buffer;
+}
+
+void* Commands::Buffer::allocate(size_t size, size_t alignment)
+{
+    while (true)
+    {
+        if (this->block < this->blocks.size())
+        {
+            auto& block = this->blocks[this->block];
+            size_t offset = (this->offset + alignment - 1) / alignment * alignment;
+            if (offset + size <= block.size)
+            {
+                this->offset = offset + size;
+                return block.data.get() + offset;
+            }
+
+            // The command doesn't fit in the current block, move on to the next one.
+            this->block += 1;
+            this->offset = 0;
+        }
+        else
+        {
+            size_t blockSize = std::max(size, BlockSize);
+            this->blocks.push_back({std::make_unique<std::byte[]>(blockSize), blockSize});
+        }
+    }
+}
+
+void Commands::Buffer::flush(World* world)
+{
+    for (auto& command : this->commands)
+    {
+        if (world != nullptr)
+            command.call(command.object, *world);
+        else
+            command.destroy(command.object);
+    }
+
+    this->commands.clear();
+    this->block = 0;
+    this->offset = 0;
+}
@@ -0,0 +1,241 @@
+#include <cubos/core/ecs/hierarchy.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+using namespace cubos::core::ecs;
+
+void Hierarchy::add(uint64_t entity, const glm::mat4& local)
+{
+    auto index = static_cast<uint32_t>(entity);
+    if (index >= this->nodes.size())
+        this->nodes.resize(index + 1);
+
+    // A node left behind by an older version of the entity must not pass its relationships on.
+    if (this->nodes[index].position != None && this->nodes[index].entity != entity)
+        this->remove(this->nodes[index].entity);
+
+    auto& node = this->nodes[index];
+    assert(node.position == None && "Entity is already in the hierarchy");
+    node.entity = entity;
+    node.parent = None;
+    node.children.clear();
+    this->push(index, local);
+}
+
+void Hierarchy::remove(uint64_t entity)
+{
+    if (!this->contains(entity))
+        return;
+
+    auto index = static_cast<uint32_t>(entity);
+    this->detach(index);
+
+    // The children become roots, so their world transforms change.
+    for (auto child : this->nodes[index].children)
+    {
+        this->nodes[child].parent = None;
+        this->markDirty(child);
+    }
+    this->nodes[index].children.clear();
+
+    // Swap the entity with the last position and pop it.
+    uint32_t position = this->nodes[index].position;
+    uint32_t last = static_cast<uint32_t>(this->order.size() - 1);
+    this->order[position] = this->order[last];
+    this->locals[position] = this->locals[last];
+    this->worlds[position] = this->worlds[last];
+    this->dirty[position] = this->dirty[last];
+    this->nodes[this->order[position]].position = position;
+
+    this->order.pop_back();
+    this->parents.pop_back();
+    this->locals.pop_back();
+    this->worlds.pop_back();
+    this->dirty.pop_back();
+    this->nodes[index].position = None;
+    this->orderChanged = true;
+}
+
+bool Hierarchy::contains(uint64_t entity) const
+{
+    auto index = static_cast<uint32_t>(entity);
+    return index < this->nodes.size() && this->nodes[index].position != None && this->nodes[index].entity == entity;
+}
+
+bool Hierarchy::setParent(uint64_t child, uint64_t parent)
+{
+    assert(this->contains(child) && this->contains(parent));
+    auto childIndex = static_cast<uint32_t>(child);
+    auto parentIndex = static_cast<uint32_t>(parent);
+
+    // Refuse to make an entity a descendant of itself.
+    for (uint32_t ancestor = parentIndex; ancestor != None; ancestor = this->nodes[ancestor].parent)
+    {
+        if (ancestor == childIndex)
+            return false;
+    }
+
+    this->detach(childIndex);
+    this->nodes[childIndex].parent = parentIndex;
+    this->nodes[parentIndex].children.push_back(childIndex);
+    this->markDirty(childIndex);
+    this->orderChanged = true;
+    return true;
+}
+
+void Hierarchy::clearParent(uint64_t child)
+{
+    assert(this->contains(child));
+    auto index = static_cast<uint32_t>(child);
+    if (this->nodes[index].parent == None)
+        return;
+
+    this->detach(index);
+    this->markDirty(index);
+    this->orderChanged = true;
+}
+
+uint64_t Hierarchy::getParent(uint64_t entity) const
+{
+    assert(this->contains(entity));
+    uint32_t parent = this->nodes[static_cast<uint32_t>(entity)].parent;
+    return parent == None ? UINT64_MAX : this->nodes[parent].entity;
+}
+
+void Hierarchy::setLocalTransform(uint64_t entity, const glm::mat4& local)
+{
+    assert(this->contains(entity));
+    auto index = static_cast<uint32_t>(entity);
+    this->locals[this->nodes[index].position] = local;
+    this->markDirty(index);
+}
+
+const glm::mat4& Hierarchy::getLocalTransform(uint64_t entity) const
+{
+    assert(this->contains(entity));
+    return this->locals[this->nodes[static_cast<uint32_t>(entity)].position];
+}
+
+const glm::mat4& Hierarchy::getWorldTransform(uint64_t entity) const
+{
+    assert(this->contains(entity));
+    return this->worlds[this->nodes[static_cast<uint32_t>(entity)].position];
+}
+
+void Hierarchy::update()
+{
+    if (this->orderChanged)
+        this->rebuild();
+    if (this->dirtyEntities.empty())
+        return;
+
+    // Ancestors come before their descendants, so walking the dirty entities by position recomputes each dirty
+    // subtree once: the walk of an ancestor clears the flags of the dirty entities below it.
+    std::vector<uint32_t> positions;
+    positions.reserve(this->dirtyEntities.size());
+    for (auto index : this->dirtyEntities)
+    {
+        // Entities may have been removed after being marked.
+        if (this->nodes[index].position != None)
+            positions.push_back(this->nodes[index].position);
+    }
+    std::sort(positions.begin(), positions.end());
+
+    for (auto start : positions)
+    {
+        if (this->dirty[start] == 0)
+            continue;
+
+        this->stack.push_back(start);
+        while (!this->stack.empty())
+        {
+            uint32_t position = this->stack.back();
+            this->stack.pop_back();
+
+            uint32_t parent = this->parents[position];
+            this->worlds[position] =
+                parent == None ? this->locals[position] : this->worlds[parent] * this->locals[position];
+            this->dirty[position] = 0;
+            for (auto child : this->nodes[this->order[position]].children)
+                this->stack.push_back(this->nodes[child].position);
+        }
+    }
+
+    this->dirtyEntities.clear();
+}
+
+void Hierarchy::push(uint32_t index, const glm::mat4& local)
+{
+    this->nodes[index].position = static_cast<uint32_t>(this->order.size());
+    this->order.push_back(index);
+    this->parents.push_back(None);
+    this->locals.push_back(local);
+    this->worlds.push_back(local);
+    this->dirty.push_back(0);
+    this->orderChanged = true;
+}
+
+void Hierarchy::markDirty(uint32_t index)
+{
+    uint32_t position = this->nodes[index].position;
+    if (this->dirty[position] != 0)
+        return;
+
+    this->dirty[position] = 1;
+    this->dirtyEntities.push_back(index);
+}
+
+void Hierarchy::detach(uint32_t index)
+{
+    uint32_t parent = this->nodes[index].parent;
+    if (parent == None)
+        return;
+
+    auto& siblings = this->nodes[parent].children;
+    siblings.erase(std::find(siblings.begin(), siblings.end(), index));
+    this->nodes[index].parent = None;
+}
+
+void Hierarchy::rebuild()
+{
+    // Roots keep their relative order, followed by each depth level.
+    std::vector<uint32_t> newOrder;
+    newOrder.reserve(this->order.size());
+    for (auto index : this->order)
+    {
+        if (this->nodes[index].parent == None)
+            newOrder.push_back(index);
+    }
+    for (size_t i = 0; i < newOrder.size(); ++i)
+    {
+        for (auto child : this->nodes[newOrder[i]].children)
+            newOrder.push_back(child);
+    }
+    assert(newOrder.size() == this->order.size());
+
+    std::vector<glm::mat4> newLocals(newOrder.size());
+    std::vector<glm::mat4> newWorlds(newOrder.size());
+    std::vector<uint8_t> newDirty(newOrder.size());
+    for (size_t i = 0; i < newOrder.size(); ++i)
+    {
+        uint32_t old = this->nodes[newOrder[i]].position;
+        newLocals[i] = this->locals[old];
+        newWorlds[i] = this->worlds[old];
+        newDirty[i] = this->dirty[old];
+    }
+
+    for (size_t i = 0; i < newOrder.size(); ++i)
+        this->nodes[newOrder[i]].position = static_cast<uint32_t>(i);
+    for (size_t i = 0; i < newOrder.size(); ++i)
+    {
+        uint32_t parent = this->nodes[newOrder[i]].parent;
+        this->parents[i] = parent == None ? None : this->nodes[parent].position;
+    }
+
+    this->order = std::move(newOrder);
+    this->locals = std::move(newLocals);
+    this->worlds = std::move(newWorlds);
+    this->dirty = std::move(newDirty);
+    this->orderChanged = false;
+}
@@ -0,0 +1,100 @@
+#include <cubos/core/ecs/mask_matcher.hpp>
+
+#include <bit>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CUBOS_CORE_ECS_MASK_MATCHER_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#define CUBOS_CORE_ECS_MASK_MATCHER_AVX2
+#include <immintrin.h>
+#endif
+
+using namespace cubos::core::ecs;
+
+/// Appends the entities of a group whose bits are set in a match bitmap.
+/// @param bits Bitmap where bit i is set if entity first + i matches.
+static inline void pushMatches(uint32_t bits, uint32_t first, std::vector<uint32_t>& indices)
+{
+    while (bits != 0)
+    {
+        indices.push_back(first + uint32_t(std::countr_zero(bits)));
+        bits &= bits - 1;
+    }
+}
+
+/// Matches entities with a single mask word, which alternate version and mask words in memory.
+/// The version words are ANDed with zero, so they always compare equal.
+static void matchSingleWord(const uint32_t* entityData, size_t count, uint32_t mask, std::vector<uint32_t>& indices)
+{
+    size_t i = 0;
+
+#if defined(CUBOS_CORE_ECS_MASK_MATCHER_AVX2)
+    __m256i pattern8 = _mm256_set_epi32(int(mask), 0, int(mask), 0, int(mask), 0, int(mask), 0);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(entityData + i * 2));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(entityData + i * 2 + 8));
+        __m256i ea = _mm256_cmpeq_epi32(_mm256_and_si256(a, pattern8), pattern8);
+        __m256i eb = _mm256_cmpeq_epi32(_mm256_and_si256(b, pattern8), pattern8);
+        uint32_t bits = uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(ea))) |
+                        (uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(eb))) << 8);
+
+        // Keep only the bits of the mask lanes and compact them, one bit per entity.
+        bits &= 0xAAAA;
+        if (bits == 0)
+            continue;
+        uint32_t compact = 0;
+        for (uint32_t e = 0; e < 8; ++e)
+            compact |= ((bits >> (e * 2 + 1)) & 1u) << e;
+        pushMatches(compact, uint32_t(i), indices);
+    }
+#endif
+
+#if defined(CUBOS_CORE_ECS_MASK_MATCHER_SSE2)
+    __m128i pattern4 = _mm_set_epi32(int(mask), 0, int(mask), 0);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(entityData + i * 2));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(entityData + i * 2 + 4));
+        __m128i ea = _mm_cmpeq_epi32(_mm_and_si128(a, pattern4), pattern4);
+        __m128i eb = _mm_cmpeq_epi32(_mm_and_si128(b, pattern4), pattern4);
+        uint32_t bits = uint32_t(_mm_movemask_ps(_mm_castsi128_ps(ea))) |
+                        (uint32_t(_mm_movemask_ps(_mm_castsi128_ps(eb))) << 4);
+
+        bits &= 0xAA;
+        if (bits == 0)
+            continue;
+        uint32_t compact = ((bits >> 1) & 1u) | ((bits >> 2) & 2u) | ((bits >> 3) & 4u) | ((bits >> 4) & 8u);
+        pushMatches(compact, uint32_t(i), indices);
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        if ((entityData[i * 2 + 1] & mask) == mask)
+            indices.push_back(uint32_t(i));
+    }
+}
+
+void cubos::core::ecs::matchMasks(const uint32_t* entityData, size_t stride, size_t count, const uint32_t* mask,
+                                  std::vector<uint32_t>& indices)
+{
+    if (stride == 2)
+    {
+        matchSingleWord(entityData, count, mask[0], indices);
+        return;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint32_t* words = entityData + i * stride + 1;
+        bool matches = true;
+        for (size_t w = 0; w + 1 < stride; ++w)
+            matches &= (words[w] & mask[w]) == mask[w];
+        if (matches)
+            indices.push_back(uint32_t(i));
+    }
+}
@@ -0,0 +1,101 @@
+#include <cubos/core/ecs/scheduler.hpp>
+#include <cubos/core/log.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+using namespace cubos::core;
+using namespace cubos::core::ecs;
+
+bool System::conflictsWith(const System& other) const
+{
+    if (this->exclusive || other.exclusive)
+        return true;
+
+    for (auto& a : this->accesses)
+        for (auto& b : other.accesses)
+            if (a.type == b.type && a.kind == b.kind && (a.writes || b.writes))
+                return true;
+
+    return false;
+}
+
+void Scheduler::run(World& world, ThreadPool& pool)
+{
+    size_t count = this->systems.size();
+    this->timings.resize(count);
+
+    // Build the dependency graph: each system waits for the previously added systems it conflicts with.
+    std::vector<std::vector<size_t>> dependents(count);
+    auto dependencies = std::make_unique<std::atomic<size_t>[]>(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        dependencies[i] = 0;
+        for (size_t j = 0; j < i; ++j)
+        {
+            if (this->systems[i].conflictsWith(this->systems[j]))
+            {
+                dependents[j].push_back(i);
+                dependencies[i] += 1;
+            }
+        }
+    }
+
+    // Each task decrements the remaining count as its very last action: once it reaches zero, run() returns and
+    // destroys everything the tasks captured by reference.
+    std::atomic<size_t> remaining(count);
+    std::function<void(size_t)> schedule = [&](size_t i) {
+        pool.addTask([this, &world, &dependents, &dependencies, &schedule, &remaining, i]() {
+            auto start = std::chrono::steady_clock::now();
+            this->systems[i].function(world);
+            auto end = std::chrono::steady_clock::now();
+            this->timings[i] = {this->systems[i].name,
+                                std::chrono::duration<double, std::milli>(end - start).count()};
+
+            // Schedule the dependents which have no other dependencies left.
+            for (auto dependent : dependents[i])
+            {
+                if (dependencies[dependent].fetch_sub(1) == 1)
+                    schedule(dependent);
+            }
+
+            remaining.fetch_sub(1, std::memory_order_release);
+        });
+    };
+
+    // Find the systems without dependencies before scheduling any of them, as the ones which are already running
+    // may bring the dependency counts of other systems to zero and schedule them by themselves.
+    std::vector<size_t> roots;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (dependencies[i] == 0)
+            roots.push_back(i);
+    }
+
+    for (auto i : roots)
+        schedule(i);
+
+    while (remaining.load(std::memory_order_acquire) != 0)
+    {
+        if (!pool.runPendingTask())
+            std::this_thread::yield();
+    }
+}
+
+const std::vector<Scheduler::Timing>& Scheduler::getTimings() const
+{
+    return this->timings;
+}
+
+void Scheduler::logTimings() const
+{
+    auto sorted = this->timings;
+    std::sort(sorted.begin(), sorted.end(), [](const Timing& a, const Timing& b) {
+        return a.milliseconds > b.milliseconds;
+    });
+
+    for (auto& timing : sorted)
+        logInfo("System \"{}\" took {:.3f} ms", timing.name, timing.milliseconds);
+}
@@ -1,4 +1,8 @@
 #include <cubos/core/ecs/world.hpp>
+#include <cubos/core/ecs/mask_matcher.hpp>
+#include <cubos/core/log.hpp>
+
+#include <cstring>
 
 using namespace cubos::core::ecs;
 
@@ -10,16 +14,392 @@ World::~World()
     }
 }
 
+uint64_t World::reserve()
+{
+    int64_t cursor = freeCursor.fetch_sub(1, std::memory_order_relaxed) - 1;
+    if (cursor >= 0)
+    {
+        // Reuse the index of a removed entity, whose version was already incremented when it was removed.
+        uint32_t index = availableEntities[static_cast<size_t>(cursor)];
+        return ((uint64_t)entityData[index * elementsPerEntity] << 32) | index;
+    }
+
+    // New entities are appended in the order they were reserved.
+    return nextEntityId + static_cast<size_t>(-cursor - 1);
+}
+
+void World::createReserved()
+{
+    int64_t cursor = freeCursor.load(std::memory_order_relaxed);
+    if (cursor == static_cast<int64_t>(availableEntities.size()))
+        return;
+
+    if (cursor < 0)
+    {
+        appendEntities(static_cast<size_t>(-cursor));
+        cursor = 0;
+    }
+
+    availableEntities.resize(static_cast<size_t>(cursor));
+    freeCursor.store(cursor, std::memory_order_relaxed);
+}
+
 void World::remove(uint64_t entity)
 {
+    createReserved();
+
     uint32_t entityIndex = (uint32_t)entity;
     uint32_t entityVersion = entity >> 32;
     if (entityVersion != entityData[entityIndex * elementsPerEntity])
         return;
 
+    hierarchy.remove(entity);
     entityData[entityIndex * elementsPerEntity] = entityVersion + 1;
+    availableEntities.push_back(entityIndex);
+    freeCursor.store(static_cast<int64_t>(availableEntities.size()), std::memory_order_relaxed);
     for (size_t i = 1; i < elementsPerEntity; i++)
     {
+        uint32_t mask = entityData[entityIndex * elementsPerEntity + i];
+        for (size_t bit = 0; mask != 0; bit++, mask >>= 1)
+        {
+            if (mask & 1)
+                storages[(i - 1) * 32 + bit]->erase(entityIndex);
+        }
         entityData[entityIndex * elementsPerEntity + i] = 0;
     }
+
+    if (!queries.empty())
+        updateQueries(entityIndex);
+}
+
+void World::removeBatch(std::span<const uint64_t> entities)
+{
+    createReserved();
+
+    // Invalidate the entities first, so that duplicates and already removed entities are skipped.
+    std::vector<uint32_t> indices;
+    indices.reserve(entities.size());
+    for (auto entity : entities)
+    {
+        uint32_t entityIndex = (uint32_t)entity;
+        uint32_t entityVersion = entity >> 32;
+        if (entityVersion != entityData[entityIndex * elementsPerEntity])
+            continue;
+
+        hierarchy.remove(entity);
+        entityData[entityIndex * elementsPerEntity] = entityVersion + 1;
+        indices.push_back(entityIndex);
+    }
+    availableEntities.insert(availableEntities.end(), indices.begin(), indices.end());
+    freeCursor.store(static_cast<int64_t>(availableEntities.size()), std::memory_order_relaxed);
+
+    // Erase the components storage by storage, and then clear the masks.
+    for (size_t id = 0; id < storages.size(); id++)
+    {
+        for (auto entityIndex : indices)
+        {
+            if (entityData[entityIndex * elementsPerEntity + 1 + id / 32] & (1u << (id % 32)))
+                storages[id]->erase(entityIndex);
+        }
+    }
+
+    for (auto entityIndex : indices)
+    {
+        for (size_t i = 1; i < elementsPerEntity; i++)
+            entityData[entityIndex * elementsPerEntity + i] = 0;
+        if (!queries.empty())
+            updateQueries(entityIndex);
+    }
+}
+
+/// Identifies the beginning of a world snapshot.
+static const char SnapshotMagic[8] = {'C', 'U', 'B', 'O', 'S', 'W', 'L', 'D'};
+
+/// Version of the snapshot format, which must be incremented whenever the format changes.
+static constexpr uint32_t SnapshotVersion = 2;
+
+/// Header written at the beginning of a world snapshot.
+struct SnapshotHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t tick;
+    uint64_t storageCount;
+    uint64_t elementsPerEntity;
+    uint64_t entityCount;
+    uint64_t availableCount;
+};
+
+void World::snapshot(memory::Stream& stream) const
+{
+    assert(freeCursor.load() == static_cast<int64_t>(availableEntities.size()) &&
+           "Reserved entities must be created before taking a snapshot");
+
+    SnapshotHeader header;
+    std::memcpy(header.magic, SnapshotMagic, sizeof(SnapshotMagic));
+    header.version = SnapshotVersion;
+    header.tick = tick;
+    header.storageCount = storages.size();
+    header.elementsPerEntity = elementsPerEntity;
+    header.entityCount = nextEntityId;
+    header.availableCount = availableEntities.size();
+    stream.write(&header, sizeof(header));
+    if (!entityData.empty())
+        stream.write(entityData.data(), entityData.size() * sizeof(uint32_t));
+    if (!availableEntities.empty())
+        stream.write(availableEntities.data(), availableEntities.size() * sizeof(uint32_t));
+
+    auto owners = getComponentOwners();
+    for (size_t id = 0; id < storages.size(); id++)
+    {
+        if (!storages[id]->snapshot(stream, owners[id]))
+        {
+            logWarning("Component {} can't be written to a snapshot, as it isn't trivially copyable or serializable",
+                       id);
+        }
+    }
+}
+
+bool World::restore(memory::Stream& stream)
+{
+    SnapshotHeader header;
+    if (stream.read(&header, sizeof(header)) != sizeof(header) ||
+        std::memcmp(header.magic, SnapshotMagic, sizeof(SnapshotMagic)) != 0 || header.version != SnapshotVersion)
+    {
+        logError("Couldn't restore world: the stream doesn't contain a valid snapshot");
+        return false;
+    }
+
+    if (header.storageCount != storages.size())
+    {
+        logError("Couldn't restore world: the snapshot has {} component types, but the world has {}",
+                 header.storageCount, storages.size());
+        return false;
+    }
+
+    if (header.elementsPerEntity != elementsPerEntity)
+    {
+        logError("Couldn't restore world: the snapshot was taken with a different maximum number of component types");
+        return false;
+    }
+
+    // Make sure the stream is long enough for the entity table before allocating it, as a corrupt header could
+    // otherwise ask for an arbitrary amount of memory.
+    auto start = stream.tell();
+    stream.seek(0, memory::SeekOrigin::End);
+    auto remaining = static_cast<uint64_t>(stream.tell() - start);
+    stream.seek(static_cast<int64_t>(start), memory::SeekOrigin::Begin);
+    if (header.availableCount > header.entityCount || header.entityCount > UINT32_MAX ||
+        header.entityCount * elementsPerEntity + header.availableCount > remaining / sizeof(uint32_t))
+    {
+        logError("Couldn't restore world: the snapshot is truncated or corrupt");
+        return false;
+    }
+
+    std::vector<uint32_t> newEntityData(header.entityCount * elementsPerEntity);
+    std::vector<uint32_t> newAvailableEntities(header.availableCount);
+    size_t entityBytes = newEntityData.size() * sizeof(uint32_t);
+    size_t availableBytes = newAvailableEntities.size() * sizeof(uint32_t);
+    if ((entityBytes > 0 && stream.read(newEntityData.data(), entityBytes) != entityBytes) ||
+        (availableBytes > 0 && stream.read(newAvailableEntities.data(), availableBytes) != availableBytes))
+    {
+        logError("Couldn't restore world: the snapshot is truncated");
+        return false;
+    }
+
+    // Only now that the entity table was read is the current state of the world replaced. The archetype table is
+    // emptied at once, which leaves nothing for the archetype storages to erase.
+    archetypes.clear();
+    auto owners = getComponentOwners();
+    for (size_t id = 0; id < storages.size(); id++)
+    {
+        for (auto entityIndex : owners[id])
+            storages[id]->erase(entityIndex);
+    }
+
+    nextEntityId = header.entityCount;
+    tick = header.tick;
+    entityData.swap(newEntityData);
+    availableEntities.swap(newAvailableEntities);
+    freeCursor.store(static_cast<int64_t>(availableEntities.size()), std::memory_order_relaxed);
+
+    // The hierarchy isn't part of the snapshot, so only the entities which still exist keep their nodes.
+    std::vector<uint64_t> stale;
+    hierarchy.forEach([&](uint64_t entity, const glm::mat4&) {
+        auto entityIndex = static_cast<uint32_t>(entity);
+        if (entityIndex >= nextEntityId || entity >> 32 != entityData[entityIndex * elementsPerEntity])
+            stale.push_back(entity);
+    });
+    for (auto entity : stale)
+        hierarchy.remove(entity);
+
+    bool truncated = false;
+    std::vector<bool> restored(storages.size(), false);
+    owners = getComponentOwners();
+    for (size_t id = 0; id < storages.size(); id++)
+    {
+        auto result = truncated ? RestoreResult::Truncated : storages[id]->restore(stream, owners[id]);
+        if (result == RestoreResult::Restored)
+        {
+            restored[id] = true;
+            continue;
+        }
+
+        // The component wasn't written or couldn't be read, so the entities are left without it.
+        truncated = truncated || result == RestoreResult::Truncated;
+        for (auto entityIndex : owners[id])
+            entityData[entityIndex * elementsPerEntity + 1 + id / 32] &= ~(1u << (id % 32));
+    }
+
+    if (truncated)
+        logError("Couldn't restore every component of the world: the snapshot is truncated");
+
+    // Archetype stored components are inserted together, the same way as in createBatch, so that each entity is
+    // placed directly on its final archetype instead of migrating once per component.
+    std::vector<size_t> columns;
+    std::vector<const uint32_t*> columnEntities;
+    std::vector<size_t> columnCounts;
+    std::vector<void*> columnValues;
+    for (size_t id = 0; id < storages.size(); id++)
+    {
+        size_t column;
+        void* values = restored[id] ? storages[id]->getRestored(column) : nullptr;
+        if (values != nullptr)
+        {
+            columns.push_back(column);
+            columnEntities.push_back(owners[id].data());
+            columnCounts.push_back(owners[id].size());
+            columnValues.push_back(values);
+        }
+    }
+    archetypes.insertRows(columns.size(), columns.data(), columnEntities.data(), columnCounts.data(),
+                          columnValues.data());
+
+    // The ticks are kept next to the values, so they are only set once every value is in place, run by run.
+    for (size_t id = 0; id < storages.size(); id++)
+    {
+        storages[id]->clearRestored();
+        if (!restored[id])
+            continue;
+
+        auto& indices = owners[id];
+        for (size_t i = 0; i < indices.size();)
+        {
+            size_t end = i + 1;
+            while (end < indices.size() && indices[end] == indices[end - 1] + 1)
+                ++end;
+            storages[id]->markAdded(indices[i], end - i, tick);
+            i = end;
+        }
+    }
+
+    // The queries are rebuilt from scratch, as most entities may have changed.
+    for (auto& query : queries)
+    {
+        query->entities.clear();
+        query->positions.assign(nextEntityId, UINT32_MAX);
+        if (nextEntityId > 0)
+            matchMasks(entityData.data(), elementsPerEntity, nextEntityId, query->mask.data(), query->entities);
+        for (size_t i = 0; i < query->entities.size(); i++)
+            query->positions[query->entities[i]] = static_cast<uint32_t>(i);
+    }
+
+    return !truncated;
+}
+
+std::vector<std::vector<uint32_t>> World::getComponentOwners() const
+{
+    std::vector<std::vector<uint32_t>> owners(storages.size());
+    for (uint32_t entityIndex = 0; entityIndex < nextEntityId; entityIndex++)
+    {
+        for (size_t i = 1; i < elementsPerEntity; i++)
+        {
+            uint32_t mask = entityData[entityIndex * elementsPerEntity + i];
+            for (size_t bit = 0; mask != 0; bit++, mask >>= 1)
+            {
+                if (mask & 1)
+                    owners[(i - 1) * 32 + bit].push_back(entityIndex);
+            }
+        }
+    }
+
+    return owners;
+}
+
+uint32_t World::getTick() const
+{
+    return tick;
+}
+
+uint32_t World::advanceTick()
+{
+    return tick++;
+}
+
+Hierarchy& World::getHierarchy()
+{
+    return hierarchy;
+}
+
+const Hierarchy& World::getHierarchy() const
+{
+    return hierarchy;
+}
+
+uint32_t World::appendEntities(size_t count)
+{
+    auto first = static_cast<uint32_t>(nextEntityId);
+    nextEntityId += count;
+    entityData.resize(nextEntityId * elementsPerEntity, 0);
+    return first;
+}
+
+World::QueryState& World::getQueryState(const ComponentMask& mask)
+{
+    for (auto& query : queries)
+    {
+        if (query->mask == mask)
+            return *query;
+    }
+
+    auto query = std::make_unique<QueryState>();
+    query->mask = mask;
+    query->positions.resize(nextEntityId, UINT32_MAX);
+    if (nextEntityId > 0)
+        matchMasks(entityData.data(), elementsPerEntity, nextEntityId, mask.data(), query->entities);
+    for (size_t i = 0; i < query->entities.size(); i++)
+        query->positions[query->entities[i]] = static_cast<uint32_t>(i);
+
+    queries.push_back(std::move(query));
+    return *queries.back();
+}
+
+void World::updateQueries(uint32_t entityIndex)
+{
+    const uint32_t* words = &entityData[entityIndex * elementsPerEntity + 1];
+    for (auto& query : queries)
+    {
+        bool matches = true;
+        for (size_t i = 0; i < query->mask.size(); i++)
+            matches = matches && (words[i] & query->mask[i]) == query->mask[i];
+
+        if (query->positions.size() <= entityIndex)
+            query->positions.resize(entityIndex + 1, UINT32_MAX);
+        uint32_t& position = query->positions[entityIndex];
+
+        if (matches && position == UINT32_MAX)
+        {
+            position = static_cast<uint32_t>(query->entities.size());
+            query->entities.push_back(entityIndex);
+        }
+        else if (!matches && position != UINT32_MAX)
+        {
+            // Swap the entity with the last one and pop it.
+            uint32_t last = query->entities.back();
+            query->entities[position] = last;
+            query->positions[last] = position;
+            query->entities.pop_back();
+            position = UINT32_MAX;
+        }
+    }
 }
@@ -0,0 +1,255 @@
+#include <cubos/core/gl/compressed_grid.hpp>
+#include <cubos/core/log.hpp>
+
+#include <algorithm>
+
+using namespace cubos::core::gl;
+
+/// @param count The number of materials in a palette.
+/// @return The smallest number of bits per voxel which can index the palette.
+static uint8_t bitsFor(size_t count)
+{
+    if (count <= 1)
+        return 0;
+    else if (count <= 2)
+        return 1;
+    else if (count <= 4)
+        return 2;
+    else if (count <= 16)
+        return 4;
+    else if (count <= 256)
+        return 8;
+    return 16;
+}
+
+CompressedGrid::CompressedGrid() : CompressedGrid(glm::uvec3(1, 1, 1))
+{
+}
+
+CompressedGrid::CompressedGrid(const glm::uvec3& size)
+{
+    if (size.x < 1 || size.y < 1 || size.z < 1)
+    {
+        logWarning("Grid size must be at least 1 in each dimension: was ({}, {}, {}), defaulting to (1, 1, 1).", size.x,
+                   size.y, size.z);
+        this->size = {1, 1, 1};
+    }
+    else
+        this->size = size;
+    this->clear();
+}
+
+CompressedGrid::CompressedGrid(const Grid& grid) : size(grid.getSize())
+{
+    std::vector<uint16_t> materials(this->getVoxelCount());
+    size_t i = 0;
+    for (int z = 0; z < static_cast<int>(this->size.z); ++z)
+        for (int y = 0; y < static_cast<int>(this->size.y); ++y)
+            for (int x = 0; x < static_cast<int>(this->size.x); ++x)
+                materials[i++] = grid.get({x, y, z});
+    this->assign(materials);
+}
+
+const glm::uvec3& CompressedGrid::getSize() const
+{
+    return this->size;
+}
+
+void CompressedGrid::clear()
+{
+    this->mode = Mode::Palette;
+    this->bits = 0;
+    this->palette.assign(1, 0);
+    this->data.clear();
+    this->runs.clear();
+}
+
+uint16_t CompressedGrid::get(const glm::ivec3& position) const
+{
+    assert(position.x >= 0 && position.x < this->size.x && position.y >= 0 && position.y < this->size.y &&
+           position.z >= 0 && position.z < this->size.z);
+    size_t index = position.x + position.y * size.x + position.z * size.x * size.y;
+
+    if (this->mode == Mode::RunLength)
+    {
+        auto it = std::upper_bound(this->runs.begin(), this->runs.end(), index,
+                                   [](size_t index, const Run& run) { return index < run.end; });
+        return it->mat;
+    }
+
+    uint16_t value = this->getPacked(index);
+    return this->bits == 16 ? value : this->palette[value];
+}
+
+void CompressedGrid::set(const glm::ivec3& position, uint16_t mat)
+{
+    assert(position.x >= 0 && position.x < this->size.x && position.y >= 0 && position.y < this->size.y &&
+           position.z >= 0 && position.z < this->size.z);
+    size_t index = position.x + position.y * size.x + position.z * size.x * size.y;
+
+    if (this->mode == Mode::RunLength)
+        this->assign(this->getMaterials());
+
+    if (this->bits == 16)
+    {
+        this->setPacked(index, mat);
+        return;
+    }
+
+    auto it = std::find(this->palette.begin(), this->palette.end(), mat);
+    if (it == this->palette.end())
+    {
+        if (this->palette.size() == (size_t(1) << this->bits))
+        {
+            uint8_t wider = bitsFor(this->palette.size() + 1);
+            if (wider == 16)
+            {
+                // Too many materials for a palette, store them directly.
+                auto materials = this->getMaterials();
+                this->bits = 16;
+                this->palette.clear();
+                this->data.assign((this->getVoxelCount() * 16 + 63) / 64, 0);
+                for (size_t i = 0; i < materials.size(); ++i)
+                    this->setPacked(i, materials[i]);
+                this->setPacked(index, mat);
+                return;
+            }
+
+            this->repack(wider);
+        }
+
+        this->palette.push_back(mat);
+        it = this->palette.end() - 1;
+    }
+
+    this->setPacked(index, static_cast<uint16_t>(it - this->palette.begin()));
+}
+
+void CompressedGrid::compact(bool runLength)
+{
+    auto materials = this->getMaterials();
+    this->assign(materials);
+    if (!runLength)
+        return;
+
+    this->mode = Mode::RunLength;
+    this->palette.clear();
+    this->data.clear();
+    for (size_t i = 0; i < materials.size(); ++i)
+    {
+        if (!this->runs.empty() && this->runs.back().mat == materials[i])
+            this->runs.back().end += 1;
+        else
+            this->runs.push_back({static_cast<uint32_t>(i + 1), materials[i]});
+    }
+    this->runs.shrink_to_fit();
+}
+
+Grid CompressedGrid::decompress() const
+{
+    return Grid(this->size, this->getMaterials());
+}
+
+CompressedGrid::Mode CompressedGrid::getMode() const
+{
+    return this->mode;
+}
+
+uint8_t CompressedGrid::getBitsPerVoxel() const
+{
+    return this->bits;
+}
+
+size_t CompressedGrid::getMemoryUsage() const
+{
+    return this->palette.size() * sizeof(uint16_t) + this->data.size() * sizeof(uint64_t) +
+           this->runs.size() * sizeof(Run);
+}
+
+uint16_t CompressedGrid::getPacked(size_t index) const
+{
+    if (this->bits == 0)
+        return 0;
+
+    size_t bit = index * this->bits;
+    uint64_t mask = (uint64_t(1) << this->bits) - 1;
+    return static_cast<uint16_t>((this->data[bit / 64] >> (bit % 64)) & mask);
+}
+
+void CompressedGrid::setPacked(size_t index, uint16_t value)
+{
+    if (this->bits == 0)
+        return;
+
+    size_t bit = index * this->bits;
+    uint64_t mask = (uint64_t(1) << this->bits) - 1;
+    uint64_t& word = this->data[bit / 64];
+    word = (word & ~(mask << (bit % 64))) | (uint64_t(value) << (bit % 64));
+}
+
+void CompressedGrid::repack(uint8_t bits)
+{
+    std::vector<uint16_t> values(this->getVoxelCount());
+    for (size_t i = 0; i < values.size(); ++i)
+        values[i] = this->getPacked(i);
+
+    this->bits = bits;
+    this->data.assign((values.size() * bits + 63) / 64, 0);
+    for (size_t i = 0; i < values.size(); ++i)
+        this->setPacked(i, values[i]);
+}
+
+std::vector<uint16_t> CompressedGrid::getMaterials() const
+{
+    std::vector<uint16_t> materials(this->getVoxelCount());
+    if (this->mode == Mode::RunLength)
+    {
+        size_t i = 0;
+        for (const auto& run : this->runs)
+            for (; i < run.end; ++i)
+                materials[i] = run.mat;
+    }
+    else
+    {
+        for (size_t i = 0; i < materials.size(); ++i)
+        {
+            uint16_t value = this->getPacked(i);
+            materials[i] = this->bits == 16 ? value : this->palette[value];
+        }
+    }
+
+    return materials;
+}
+
+void CompressedGrid::assign(const std::vector<uint16_t>& materials)
+{
+    std::vector<uint16_t> palette(materials);
+    std::sort(palette.begin(), palette.end());
+    palette.erase(std::unique(palette.begin(), palette.end()), palette.end());
+
+    this->mode = Mode::Palette;
+    this->runs.clear();
+    this->bits = bitsFor(palette.size());
+    this->data.assign((materials.size() * this->bits + 63) / 64, 0);
+    if (this->bits == 16)
+    {
+        this->palette.clear();
+        for (size_t i = 0; i < materials.size(); ++i)
+            this->setPacked(i, materials[i]);
+    }
+    else
+    {
+        this->palette = std::move(palette);
+        for (size_t i = 0; i < materials.size(); ++i)
+        {
+            auto it = std::lower_bound(this->palette.begin(), this->palette.end(), materials[i]);
+            this->setPacked(i, static_cast<uint16_t>(it - this->palette.begin()));
+        }
+    }
+    this->data.shrink_to_fit();
+}
+
+size_t CompressedGrid::getVoxelCount() const
+{
+    return static_cast<size_t>(this->size.x) * this->size.y * this->size.z;
+}
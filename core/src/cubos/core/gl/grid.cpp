@@ -35,7 +35,7 @@ Grid::Grid(const glm::uvec3& size, const std::vector<uint16_t>& indices)
     this->indices = indices;
 }
 
-Grid::Grid(Grid&& other) : size(other.size)
+Grid::Grid(Grid&& other) : size(other.size), dirtyMin(other.dirtyMin), dirtyMax(other.dirtyMax)
 {
     new (&this->indices) std::vector<uint16_t>(std::move(other.indices));
 }
@@ -61,6 +61,8 @@ void Grid::setSize(const glm::uvec3& size)
     this->size = size;
     this->indices.clear();
     this->indices.resize(this->size.x * this->size.y * this->size.z, 0);
+    this->dirtyMin = {0, 0, 0};
+    this->dirtyMax = this->size;
 }
 
 const glm::uvec3& Grid::getSize() const
@@ -72,6 +74,7 @@ void Grid::clear()
 {
     for (size_t i = 0; i < this->indices.size(); i++)
         this->indices[i] = 0;
+    this->markDirty({0, 0, 0}, this->size);
 }
 
 uint16_t Grid::get(const glm::ivec3& position) const
@@ -85,7 +88,44 @@ void Grid::set(const glm::ivec3& position, uint16_t mat)
 {
     assert(position.x >= 0 && position.x < this->size.x && position.y >= 0 && position.y < this->size.y &&
            position.z >= 0 && position.z < this->size.z);
-    this->indices[position.x + position.y * size.x + position.z * size.x * size.y] = mat;
+    auto& index = this->indices[position.x + position.y * size.x + position.z * size.x * size.y];
+    if (index != mat)
+    {
+        index = mat;
+        this->markDirty(position, glm::uvec3(position) + glm::uvec3(1, 1, 1));
+    }
+}
+
+bool Grid::getDirtyRegion(glm::uvec3& min, glm::uvec3& max) const
+{
+    if (this->dirtyMin.x >= this->dirtyMax.x || this->dirtyMin.y >= this->dirtyMax.y ||
+        this->dirtyMin.z >= this->dirtyMax.z)
+        return false;
+
+    min = this->dirtyMin;
+    max = this->dirtyMax;
+    return true;
+}
+
+void Grid::clearDirtyRegion()
+{
+    this->dirtyMin = {0, 0, 0};
+    this->dirtyMax = {0, 0, 0};
+}
+
+void Grid::markDirty(const glm::uvec3& min, const glm::uvec3& max)
+{
+    glm::uvec3 oldMin, oldMax;
+    if (this->getDirtyRegion(oldMin, oldMax))
+    {
+        this->dirtyMin = glm::min(oldMin, min);
+        this->dirtyMax = glm::max(oldMax, max);
+    }
+    else
+    {
+        this->dirtyMin = min;
+        this->dirtyMax = max;
+    }
 }
 
 void Grid::serialize(memory::Serializer& serializer) const
@@ -108,4 +148,6 @@ void Grid::deserialize(memory::Deserializer& deserializer)
         this->indices.clear();
         this->indices.resize(1, 0);
     }
+    this->dirtyMin = {0, 0, 0};
+    this->dirtyMax = this->size;
 }
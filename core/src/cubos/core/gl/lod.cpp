@@ -0,0 +1,197 @@
+#include <cubos/core/gl/lod.hpp>
+#include <cubos/core/thread_pool.hpp>
+#include <cubos/core/log.hpp>
+
+#include <algorithm>
+#include <utility>
+
+using namespace cubos::core;
+using namespace cubos::core::gl;
+
+/// Computes the voxel which replaces a block of a grid when downsampling it.
+/// @param counts Scratch space for the materials of the block and the number of voxels with them.
+static uint16_t downsampleBlock(const Grid& grid, int factor, const glm::ivec3& block,
+                                std::vector<std::pair<uint16_t, int>>& counts)
+{
+    glm::ivec3 min = block * factor;
+    glm::ivec3 max = glm::min(min + glm::ivec3(factor), glm::ivec3(grid.getSize()));
+
+    counts.clear();
+    int total = 0, solid = 0;
+    glm::ivec3 x;
+    for (x.z = min.z; x.z < max.z; ++x.z)
+        for (x.y = min.y; x.y < max.y; ++x.y)
+            for (x.x = min.x; x.x < max.x; ++x.x)
+            {
+                total += 1;
+                uint16_t mat = grid.get(x);
+                if (mat == 0)
+                    continue;
+                solid += 1;
+
+                auto it = std::find_if(counts.begin(), counts.end(),
+                                       [mat](const auto& count) { return count.first == mat; });
+                if (it == counts.end())
+                    counts.emplace_back(mat, 1);
+                else
+                    it->second += 1;
+            }
+
+    if (solid * 2 < total)
+        return 0;
+
+    // Ties are broken by picking the material which appeared first.
+    auto dominant = std::max_element(counts.begin(), counts.end(),
+                                     [](const auto& a, const auto& b) { return a.second < b.second; });
+    return dominant->first;
+}
+
+Grid cubos::core::gl::downsample(const Grid& grid, int factor)
+{
+    auto& size = grid.getSize();
+    glm::uvec3 newSize = (size + glm::uvec3(factor - 1)) / glm::uvec3(factor);
+    Grid result(newSize);
+    downsample(grid, factor, result, {0, 0, 0}, size);
+    return result;
+}
+
+void cubos::core::gl::downsample(const Grid& grid, int factor, Grid& result, const glm::uvec3& min,
+                                 const glm::uvec3& max)
+{
+    // Pairs of materials and the number of voxels of the block with them.
+    std::vector<std::pair<uint16_t, int>> counts;
+
+    glm::ivec3 first = glm::ivec3(min) / factor;
+    glm::ivec3 last = (glm::ivec3(max) + glm::ivec3(factor - 1)) / factor;
+    glm::ivec3 block;
+    for (block.z = first.z; block.z < last.z; ++block.z)
+        for (block.y = first.y; block.y < last.y; ++block.y)
+            for (block.x = first.x; block.x < last.x; ++block.x)
+                result.set(block, downsampleBlock(grid, factor, block, counts));
+}
+
+/// Triangulates a whole grid, using the fastest mesher which supports the requested features.
+static void triangulateWhole(const Grid& grid, Mesh& mesh, bool occlusion)
+{
+    if (occlusion)
+        triangulate(grid, {0, 0, 0}, grid.getSize(), mesh.vertices, mesh.indices, true);
+    else
+        triangulateBinary(grid, mesh.vertices, mesh.indices);
+}
+
+void cubos::core::gl::triangulateLod(const Grid& grid, size_t level, Mesh& mesh, bool occlusion)
+{
+    mesh.vertices.clear();
+    mesh.indices.clear();
+    if (level == 0)
+    {
+        triangulateWhole(grid, mesh, occlusion);
+        return;
+    }
+
+    auto factor = 1u << level;
+    triangulateWhole(downsample(grid, int(factor)), mesh, occlusion);
+    for (auto& vertex : mesh.vertices)
+        vertex.position *= factor;
+}
+
+void cubos::core::gl::triangulateLods(const Grid& grid, size_t levelCount, std::vector<Mesh>& meshes, bool occlusion)
+{
+    if (levelCount > MaxLodLevels)
+    {
+        logWarning("Could not triangulate {} levels of detail, the maximum is {}.", levelCount, MaxLodLevels);
+        levelCount = MaxLodLevels;
+    }
+
+    meshes.resize(levelCount);
+    for (size_t level = 0; level < levelCount; ++level)
+        triangulateLod(grid, level, meshes[level], occlusion);
+}
+
+std::future<std::vector<Mesh>> cubos::core::gl::triangulateLodsAsync(const Grid& grid, size_t levelCount,
+                                                                    ThreadPool& pool, bool occlusion)
+{
+    auto promise = std::make_shared<std::promise<std::vector<Mesh>>>();
+    auto future = promise->get_future();
+    pool.addTask([&grid, levelCount, occlusion, promise]() {
+        std::vector<Mesh> meshes;
+        triangulateLods(grid, levelCount, meshes, occlusion);
+        promise->set_value(std::move(meshes));
+    });
+    return future;
+}
+
+size_t cubos::core::gl::selectLod(float distance, float lodDistance, size_t levelCount)
+{
+    size_t level = 0;
+    while (level + 1 < levelCount && distance > lodDistance)
+    {
+        level += 1;
+        lodDistance *= 2.0f;
+    }
+    return level;
+}
+
+void SectionedLods::setOcclusion(bool occlusion)
+{
+    if (this->occlusion == occlusion)
+        return;
+
+    // Forget the size of the grid, so that the next update rebuilds every level even if no voxel changed.
+    this->occlusion = occlusion;
+    this->size = {0, 0, 0};
+    for (auto& level : this->levels)
+        level.setOcclusion(occlusion);
+}
+
+bool SectionedLods::update(Grid& grid)
+{
+    glm::uvec3 min, max;
+    if (grid.getSize() != this->size)
+    {
+        this->size = grid.getSize();
+        min = {0, 0, 0};
+        max = this->size;
+
+        for (size_t level = 1; level < MaxLodLevels; ++level)
+        {
+            // Grids can't be resized to be empty, so the sections of the coarse levels of empty grids are dropped
+            // instead.
+            auto factor = 1u << level;
+            if (this->size.x == 0 || this->size.y == 0 || this->size.z == 0)
+                this->levels[level] = SectionedMesh(this->occlusion);
+            else
+                this->coarse[level - 1].setSize((this->size + glm::uvec3(factor - 1)) / glm::uvec3(factor));
+        }
+    }
+    else if (!grid.getDirtyRegion(min, max))
+        return false;
+
+    // The coarse levels are updated before the first, which clears the dirty region of the grid.
+    bool changed = false;
+    if (this->size.x != 0 && this->size.y != 0 && this->size.z != 0)
+    {
+        for (size_t level = 1; level < MaxLodLevels; ++level)
+        {
+            downsample(grid, int(1u << level), this->coarse[level - 1], min, max);
+            changed |= this->levels[level].update(this->coarse[level - 1]);
+        }
+    }
+    changed |= this->levels[0].update(grid);
+    grid.clearDirtyRegion();
+    return changed;
+}
+
+void SectionedLods::build(std::vector<Mesh>& meshes) const
+{
+    meshes.resize(MaxLodLevels);
+    for (size_t level = 0; level < MaxLodLevels; ++level)
+    {
+        this->levels[level].build(meshes[level]);
+        if (level > 0)
+        {
+            for (auto& vertex : meshes[level].vertices)
+                vertex.position *= 1u << level;
+        }
+    }
+}
@@ -0,0 +1,193 @@
+#include <cubos/core/gl/raycast.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace cubos::core::gl;
+
+OccupancyPyramid::OccupancyPyramid(const Grid& grid) : size(grid.getSize())
+{
+    for (size_t level = 0; level < LevelCount; ++level)
+    {
+        this->blocks[level] = (this->size + glm::uvec3(BlockSizes[level] - 1)) / glm::uvec3(BlockSizes[level]);
+        this->occupied[level].assign(this->blocks[level].x * this->blocks[level].y * this->blocks[level].z, 0);
+    }
+    this->update(grid, {0, 0, 0}, this->size);
+}
+
+void OccupancyPyramid::update(const Grid& grid, const glm::uvec3& min, const glm::uvec3& max)
+{
+    for (size_t level = 0; level < LevelCount; ++level)
+    {
+        auto blockSize = static_cast<unsigned>(BlockSizes[level]);
+        auto& blocks = this->blocks[level];
+        glm::uvec3 first = min / glm::uvec3(blockSize);
+        glm::uvec3 last = glm::min((max + glm::uvec3(blockSize - 1)) / glm::uvec3(blockSize), blocks);
+
+        glm::ivec3 block;
+        for (block.z = int(first.z); block.z < int(last.z); ++block.z)
+            for (block.y = int(first.y); block.y < int(last.y); ++block.y)
+                for (block.x = int(first.x); block.x < int(last.x); ++block.x)
+                {
+                    glm::ivec3 begin = block * int(blockSize);
+                    glm::ivec3 end = glm::min(begin + glm::ivec3(int(blockSize)), glm::ivec3(this->size));
+
+                    bool solid = false;
+                    glm::ivec3 x;
+                    for (x.z = begin.z; x.z < end.z && !solid; ++x.z)
+                        for (x.y = begin.y; x.y < end.y && !solid; ++x.y)
+                            for (x.x = begin.x; x.x < end.x && !solid; ++x.x)
+                                solid = grid.get(x) != 0;
+
+                    this->occupied[level][block.x + block.y * blocks.x + block.z * blocks.x * blocks.y] = solid;
+                }
+    }
+}
+
+bool OccupancyPyramid::isBlockEmpty(size_t level, const glm::ivec3& position) const
+{
+    auto& blocks = this->blocks[level];
+    glm::ivec3 block = position / BlockSizes[level];
+    return this->occupied[level][block.x + block.y * blocks.x + block.z * blocks.x * blocks.y] == 0;
+}
+
+/// Implements both raycast overloads.
+/// @param pyramid The occupancy pyramid of the grid, or nullptr to visit every voxel.
+static bool raycast(const Grid& grid, const OccupancyPyramid* pyramid, const glm::vec3& origin,
+                    const glm::vec3& direction, float maxDistance, RaycastHit& hit)
+{
+    float length = glm::length(direction);
+    if (length == 0.0f)
+        return false;
+    glm::vec3 dir = direction / length;
+    glm::ivec3 sz = glm::ivec3(grid.getSize());
+
+    // Clip the ray to the bounds of the grid, remembering through which face it enters the grid.
+    float tEnter = 0.0f, tExit = maxDistance;
+    int enterAxis = -1;
+    for (int a = 0; a < 3; ++a)
+    {
+        if (dir[a] == 0.0f)
+        {
+            if (origin[a] < 0.0f || origin[a] >= float(sz[a]))
+                return false;
+            continue;
+        }
+
+        float t0 = -origin[a] / dir[a];
+        float t1 = (float(sz[a]) - origin[a]) / dir[a];
+        if (t0 > t1)
+            std::swap(t0, t1);
+        if (t0 > tEnter)
+        {
+            tEnter = t0;
+            enterAxis = a;
+        }
+        tExit = std::min(tExit, t1);
+    }
+    if (tEnter > tExit)
+        return false;
+
+    glm::ivec3 step, voxel, normal = {0, 0, 0};
+    glm::vec3 tMax, tDelta;
+    glm::vec3 start = origin + dir * tEnter;
+    for (int a = 0; a < 3; ++a)
+    {
+        step[a] = dir[a] > 0.0f ? 1 : (dir[a] < 0.0f ? -1 : 0);
+        voxel[a] = std::clamp(int(std::floor(start[a])), 0, sz[a] - 1);
+        tDelta[a] = dir[a] != 0.0f ? std::abs(1.0f / dir[a]) : std::numeric_limits<float>::infinity();
+    }
+    if (enterAxis != -1)
+        normal[enterAxis] = -step[enterAxis];
+
+    // Distance along the ray at which it crosses the next voxel boundary on each axis.
+    auto computeTMax = [&]() {
+        for (int a = 0; a < 3; ++a)
+            tMax[a] = step[a] != 0 ? (float(voxel[a] + (step[a] > 0 ? 1 : 0)) - origin[a]) / dir[a]
+                                   : std::numeric_limits<float>::infinity();
+    };
+    computeTMax();
+
+    float t = tEnter;
+    while (true)
+    {
+        // Jump over the largest empty block which contains the current voxel, if any.
+        bool skipped = false;
+        for (size_t level = OccupancyPyramid::LevelCount; pyramid != nullptr && level-- > 0;)
+        {
+            if (!pyramid->isBlockEmpty(level, voxel))
+                continue;
+
+            int blockSize = OccupancyPyramid::BlockSizes[level];
+            glm::ivec3 blockMin = (voxel / blockSize) * blockSize;
+            int axis = 0;
+            float tBlock = std::numeric_limits<float>::infinity();
+            for (int a = 0; a < 3; ++a)
+            {
+                if (step[a] == 0)
+                    continue;
+                float boundary = float(step[a] > 0 ? blockMin[a] + blockSize : blockMin[a]);
+                float ta = (boundary - origin[a]) / dir[a];
+                if (ta < tBlock)
+                {
+                    tBlock = ta;
+                    axis = a;
+                }
+            }
+            if (tBlock > tExit)
+                return false;
+
+            // Find the voxel where the ray leaves the block, making sure rounding errors don't move it sideways.
+            glm::vec3 exit = origin + dir * tBlock;
+            for (int a = 0; a < 3; ++a)
+                voxel[a] = std::clamp(int(std::floor(exit[a])), blockMin[a], blockMin[a] + blockSize - 1);
+            voxel[axis] = step[axis] > 0 ? blockMin[axis] + blockSize : blockMin[axis] - 1;
+            if (voxel[axis] < 0 || voxel[axis] >= sz[axis])
+                return false;
+
+            normal = {0, 0, 0};
+            normal[axis] = -step[axis];
+            t = tBlock;
+            computeTMax();
+            skipped = true;
+            break;
+        }
+        if (skipped)
+            continue;
+
+        uint16_t material = grid.get(voxel);
+        if (material != 0)
+        {
+            hit.position = voxel;
+            hit.normal = normal;
+            hit.material = material;
+            hit.distance = t;
+            return true;
+        }
+
+        // Step into the next voxel along the axis whose boundary is the closest.
+        int axis = tMax.x < tMax.y ? (tMax.x < tMax.z ? 0 : 2) : (tMax.y < tMax.z ? 1 : 2);
+        if (tMax[axis] > tExit)
+            return false;
+        t = tMax[axis];
+        voxel[axis] += step[axis];
+        tMax[axis] += tDelta[axis];
+        if (voxel[axis] < 0 || voxel[axis] >= sz[axis])
+            return false;
+        normal = {0, 0, 0};
+        normal[axis] = -step[axis];
+    }
+}
+
+bool cubos::core::gl::raycast(const Grid& grid, const glm::vec3& origin, const glm::vec3& direction,
+                              float maxDistance, RaycastHit& hit)
+{
+    return ::raycast(grid, nullptr, origin, direction, maxDistance, hit);
+}
+
+bool cubos::core::gl::raycast(const Grid& grid, const OccupancyPyramid& pyramid, const glm::vec3& origin,
+                              const glm::vec3& direction, float maxDistance, RaycastHit& hit)
+{
+    return ::raycast(grid, &pyramid, origin, direction, maxDistance, hit);
+}
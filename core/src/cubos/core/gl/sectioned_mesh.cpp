@@ -0,0 +1,86 @@
+#include <cubos/core/gl/sectioned_mesh.hpp>
+
+using namespace cubos::core::gl;
+
+SectionedMesh::SectionedMesh(bool occlusion) : occlusion(occlusion)
+{
+}
+
+bool SectionedMesh::update(Grid& grid)
+{
+    glm::uvec3 min, max;
+    if (grid.getSize() != this->size)
+    {
+        this->size = grid.getSize();
+        this->sections = (this->size + glm::uvec3(SectionSize - 1)) / glm::uvec3(SectionSize);
+        this->meshes.clear();
+        this->meshes.resize(this->sections.x * this->sections.y * this->sections.z);
+        min = {0, 0, 0};
+        max = this->size;
+    }
+    else if (!grid.getDirtyRegion(min, max))
+        return false;
+    grid.clearDirtyRegion();
+
+    // Empty grids have no sections, and the corners below would underflow.
+    if (this->size.x == 0 || this->size.y == 0 || this->size.z == 0)
+    {
+        this->meshes.clear();
+        return true;
+    }
+
+    // Changing a voxel may hide or reveal the faces of its neighbours, or change their occlusion, and they may be in
+    // the adjacent sections.
+    min = glm::max(min, glm::uvec3(1, 1, 1)) - glm::uvec3(1, 1, 1);
+    max = glm::min(max + glm::uvec3(1, 1, 1), this->size);
+
+    glm::uvec3 first = min / glm::uvec3(SectionSize);
+    glm::uvec3 last = (max - glm::uvec3(1, 1, 1)) / glm::uvec3(SectionSize);
+    for (uint32_t z = first.z; z <= last.z; ++z)
+        for (uint32_t y = first.y; y <= last.y; ++y)
+            for (uint32_t x = first.x; x <= last.x; ++x)
+                this->triangulateSection(grid, {x, y, z});
+    return true;
+}
+
+void SectionedMesh::setOcclusion(bool occlusion)
+{
+    if (this->occlusion == occlusion)
+        return;
+
+    // Forget the size of the grid, so that every section is triangulated again on the next update.
+    this->occlusion = occlusion;
+    this->size = {0, 0, 0};
+    this->sections = {0, 0, 0};
+    this->meshes.clear();
+}
+
+void SectionedMesh::build(Mesh& mesh) const
+{
+    mesh.vertices.clear();
+    mesh.indices.clear();
+    for (const auto& section : this->meshes)
+    {
+        auto offset = static_cast<uint32_t>(mesh.vertices.size());
+        mesh.vertices.insert(mesh.vertices.end(), section.vertices.begin(), section.vertices.end());
+        for (auto index : section.indices)
+            mesh.indices.push_back(index + offset);
+    }
+}
+
+size_t SectionedMesh::getSectionCount() const
+{
+    return this->meshes.size();
+}
+
+void SectionedMesh::triangulateSection(const Grid& grid, const glm::uvec3& section)
+{
+    auto index = section.x + section.y * this->sections.x + section.z * this->sections.x * this->sections.y;
+    auto& mesh = this->meshes[index];
+    mesh.vertices.clear();
+    mesh.indices.clear();
+
+    glm::uvec3 min = section * glm::uvec3(SectionSize);
+    glm::uvec3 max = glm::min(min + glm::uvec3(SectionSize), this->size);
+    triangulate(grid, min, max, mesh.vertices, mesh.indices, this->occlusion);
+}
@@ -1,6 +1,11 @@
 #include "cubos/core/gl/vertex.hpp"
 #include "cubos/core/gl/grid.hpp"
+#include "cubos/core/thread_pool.hpp"
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <memory>
 #include <vector>
 
 using namespace cubos;
@@ -11,6 +16,7 @@ void Vertex::serialize(memory::Serializer& serializer) const
     serializer.write(this->position, "position");
     serializer.write(this->normal, "normal");
     serializer.write(this->material, "material");
+    serializer.write(this->occlusion, "occlusion");
 }
 
 void Vertex::deserialize(memory::Deserializer& deserializer)
@@ -18,128 +24,508 @@ void Vertex::deserialize(memory::Deserializer& deserializer)
     deserializer.read(this->position);
     deserializer.read(this->normal);
     deserializer.read(this->material);
+    deserializer.read(this->occlusion);
 }
 
-void cubos::core::gl::triangulate(const Grid& grid, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+/// The normal of each face index of a packed vertex.
+static const glm::ivec3 FaceNormals[6] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+
+bool cubos::core::gl::pack(const std::vector<Vertex>& vertices, std::vector<PackedVertex>& packed)
+{
+    packed.resize(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        const auto& vertex = vertices[i];
+        if (vertex.position.x > MaxPackedCoordinate || vertex.position.y > MaxPackedCoordinate ||
+            vertex.position.z > MaxPackedCoordinate)
+        {
+            packed.clear();
+            return false;
+        }
+
+        // Voxel normals always point along one of the axes.
+        int axis = vertex.normal.x != 0.0f ? 0 : (vertex.normal.y != 0.0f ? 1 : 2);
+        int face = axis * 2 + (vertex.normal[axis] < 0.0f ? 1 : 0);
+
+        auto& p = packed[i];
+        p.position[0] = static_cast<uint8_t>(vertex.position.x);
+        p.position[1] = static_cast<uint8_t>(vertex.position.y);
+        p.position[2] = static_cast<uint8_t>(vertex.position.z);
+        p.face = static_cast<uint8_t>(face | (vertex.occlusion << 3));
+        p.material = vertex.material;
+        p.padding = 0;
+    }
+
+    return true;
+}
+
+Vertex cubos::core::gl::unpack(const PackedVertex& packed)
+{
+    Vertex vertex;
+    vertex.position = {packed.position[0], packed.position[1], packed.position[2]};
+    vertex.normal = FaceNormals[packed.face & 7];
+    vertex.material = packed.material;
+    vertex.occlusion = (packed.face >> 3) & 3;
+    return vertex;
+}
+
+/// Appends a quad to a mesh, with the same layout and winding as the quads generated by triangulate.
+/// @param occlusion The occlusion of each corner of the quad, 2 bits each, in the same order as the vertices.
+static void pushQuad(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, glm::ivec3 x, glm::ivec3 du,
+                     glm::ivec3 dv, glm::ivec3 q, bool back_face, uint16_t material, uint8_t occlusion = 0)
+{
+    auto vi = static_cast<uint32_t>(vertices.size());
+    vertices.resize(vi + 4, {{}, back_face ? -q : q, material, 0});
+    vertices[vi + 0].position = x;
+    vertices[vi + 1].position = x + du;
+    vertices[vi + 2].position = x + du + dv;
+    vertices[vi + 3].position = x + dv;
+    for (uint32_t k = 0; k < 4; ++k)
+        vertices[vi + k].occlusion = (occlusion >> (k * 2)) & 3;
+
+    // Split the quad along the diagonal between its least occluded corners, so that the occlusion is interpolated
+    // symmetrically.
+    bool flip = vertices[vi + 0].occlusion + vertices[vi + 2].occlusion >
+                vertices[vi + 1].occlusion + vertices[vi + 3].occlusion;
+    if (back_face && flip)
+        indices.insert(indices.end(), {vi + 0, vi + 3, vi + 1, vi + 1, vi + 3, vi + 2});
+    else if (back_face)
+        indices.insert(indices.end(), {vi + 0, vi + 2, vi + 1, vi + 3, vi + 2, vi + 0});
+    else if (flip)
+        indices.insert(indices.end(), {vi + 0, vi + 1, vi + 3, vi + 1, vi + 2, vi + 3});
+    else
+        indices.insert(indices.end(), {vi + 0, vi + 1, vi + 2, vi + 2, vi + 3, vi + 0});
+}
+
+/// Triangulates a range of slices of a grid, along one axis, facing one direction.
+/// Slices are independent from each other, so that different ranges can be triangulated in parallel.
+/// @param grid The grid to triangulate.
+/// @param back_face Whether to triangulate the back faces.
+/// @param d The axis perpendicular to the slices.
+/// @param begin The first slice, which may be -1 for the faces before the first voxel.
+/// @param end The slice after the last slice.
+/// @param vertices The vertices of the mesh, to which the new vertices are appended.
+/// @param indices The indices of the mesh, to which the new indices are appended.
+static void triangulateSlices(const Grid& grid, bool back_face, int d, int begin, int end,
+                              std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
 {
     std::vector<uint16_t> mask;
 
     auto& sz = grid.getSize();
 
-    // For both back and front faces.
-    bool back_face = true;
-    do
+    int u = (d + 1) % 3;
+    int v = (d + 2) % 3;
+
+    glm::ivec3 x = {0, 0, 0}, q = {0, 0, 0};
+    q[d] = 1;
+    mask.resize(sz[u] * sz[v]);
+
+    for (x[d] = begin; x[d] < end;)
+    {
+        int n = 0;
+
+        // Create mask
+        for (x[v] = 0; x[v] < int(sz[v]); ++x[v])
+            for (x[u] = 0; x[u] < int(sz[u]); ++x[u])
+            {
+                if (x[d] < 0)
+                    mask[n++] = back_face ? grid.get(x + q) : 0;
+                else if (x[d] == int(sz[d]) - 1)
+                    mask[n++] = back_face ? 0 : grid.get(x);
+                else if (grid.get(x) == 0 || grid.get(x + q) == 0)
+                    mask[n++] = back_face ? grid.get(x + q) : grid.get(x);
+                else
+                    mask[n++] = 0;
+            }
+
+        ++x[d];
+        n = 0;
+
+        // Generate mesh from mask
+        for (int j = 0; j < int(sz[v]); ++j)
+        {
+            for (int i = 0; i < int(sz[u]);)
+            {
+                if (mask[n] != 0)
+                {
+                    int w, h;
+                    for (w = 1; i + w < int(sz[u]) && mask[n + w] == mask[n]; ++w)
+                        ;
+                    bool done = false;
+                    for (h = 1; j + h < int(sz[v]); ++h)
+                    {
+                        for (int k = 0; k < w; ++k)
+                            if (mask[n + k + h * sz[u]] == 0 || mask[n + k + h * sz[u]] != mask[n])
+                            {
+                                done = true;
+                                break;
+                            }
+
+                        if (done)
+                            break;
+                    }
+
+                    x[u] = i;
+                    x[v] = j;
+
+                    glm::ivec3 du = {0, 0, 0}, dv = {0, 0, 0};
+                    du[u] = w;
+                    dv[v] = h;
+                    pushQuad(vertices, indices, x, du, dv, q, back_face, mask[n]);
+
+                    for (int l = 0; l < h; ++l)
+                        for (int k = 0; k < w; ++k)
+                            mask[n + k + l * sz[u]] = 0;
+
+                    i += w;
+                    n += w;
+                }
+                else
+                {
+                    ++i;
+                    ++n;
+                }
+            }
+        }
+    }
+}
+
+void cubos::core::gl::triangulate(const Grid& grid, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+{
+    auto& sz = grid.getSize();
+
+    // For both front and back faces, and for each axis.
+    for (int back_face = 0; back_face < 2; ++back_face)
+        for (int d = 0; d < 3; ++d)
+            triangulateSlices(grid, back_face != 0, d, -1, int(sz[d]), vertices, indices);
+}
+
+void cubos::core::gl::triangulate(const Grid& grid, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+                                  ThreadPool& pool)
+{
+    auto& sz = grid.getSize();
+
+    // Split the slices of each direction into ranges, with a few ranges per thread so that the load is balanced.
+    struct Job
+    {
+        bool back_face;
+        int d;
+        int begin, end;
+    };
+    std::vector<Job> jobs;
+    for (int back_face = 0; back_face < 2; ++back_face)
+        for (int d = 0; d < 3; ++d)
+        {
+            int slices = int(sz[d]) + 1;
+            int perJob = std::max(4, slices / int(pool.getThreadCount() + 1));
+            for (int begin = -1; begin < int(sz[d]); begin += perJob)
+                jobs.push_back({back_face != 0, d, begin, std::min(begin + perJob, int(sz[d]))});
+        }
+
+    std::vector<Mesh> parts(jobs.size());
+    pool.parallelFor(jobs.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            triangulateSlices(grid, jobs[i].back_face, jobs[i].d, jobs[i].begin, jobs[i].end, parts[i].vertices,
+                              parts[i].indices);
+    });
+
+    // Merge the parts in order, so that the mesh is the same as the one built on a single thread.
+    size_t vertexCount = vertices.size(), indexCount = indices.size();
+    for (auto& part : parts)
+    {
+        vertexCount += part.vertices.size();
+        indexCount += part.indices.size();
+    }
+    vertices.reserve(vertexCount);
+    indices.reserve(indexCount);
+    for (auto& part : parts)
+    {
+        auto offset = static_cast<uint32_t>(vertices.size());
+        vertices.insert(vertices.end(), part.vertices.begin(), part.vertices.end());
+        for (auto index : part.indices)
+            indices.push_back(index + offset);
+    }
+}
+
+/// @param grid The grid.
+/// @param x The position of the voxel.
+/// @param outside Called to get the voxels outside the grid.
+/// @return The material of the voxel.
+template <typename Outside>
+static uint16_t sample(const Grid& grid, const glm::ivec3& x, const Outside& outside)
+{
+    auto& sz = grid.getSize();
+    if (x.x >= 0 && x.y >= 0 && x.z >= 0 && x.x < int(sz.x) && x.y < int(sz.y) && x.z < int(sz.z))
+        return grid.get(x);
+    return outside(x);
+}
+
+/// Computes the occlusion of the corners of a voxel face from the voxels in front of it.
+/// @param grid The grid.
+/// @param outside Called to get the voxels outside the grid.
+/// @param p The position in front of the face.
+/// @param du The direction of the first axis of the face.
+/// @param dv The direction of the second axis of the face.
+/// @return The occlusion of each corner, 2 bits each, in the same order as the vertices of pushQuad.
+template <typename Outside>
+static uint8_t faceOcclusion(const Grid& grid, const Outside& outside, const glm::ivec3& p, const glm::ivec3& du,
+                             const glm::ivec3& dv)
+{
+    static const int signs[4][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+
+    uint8_t occlusion = 0;
+    for (int k = 0; k < 4; ++k)
     {
-        back_face = !back_face;
+        glm::ivec3 su = du * signs[k][0], sv = dv * signs[k][1];
+        int side1 = sample(grid, p + su, outside) != 0;
+        int side2 = sample(grid, p + sv, outside) != 0;
+        int corner = sample(grid, p + su + sv, outside) != 0;
+        int value = side1 && side2 ? 3 : side1 + side2 + corner;
+        occlusion |= uint8_t(value << (k * 2));
+    }
+    return occlusion;
+}
+
+/// Implements the region overload of triangulate, getting the voxels outside the grid from a function, so that the
+/// grid can be triangulated as part of a larger world.
+/// @param outside Called to get the voxels outside the grid.
+template <typename Outside>
+static void triangulateRegion(const Grid& grid, const glm::uvec3& min, const glm::uvec3& max, const Outside& outside,
+                              std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, bool occlusion)
+{
+    // Each face is described by its material and, in the lower 16 bits, by the occlusion of its corners, so that
+    // only faces with the same occlusion are merged.
+    std::vector<uint32_t> mask;
 
-        // For each axis.
+    for (int back_face = 0; back_face < 2; ++back_face)
         for (int d = 0; d < 3; ++d)
         {
             int u = (d + 1) % 3;
             int v = (d + 2) % 3;
+            int width = int(max[u]) - int(min[u]);
+            int height = int(max[v]) - int(min[v]);
 
-            glm::ivec3 x = {0, 0, 0}, q = {0, 0, 0};
+            glm::ivec3 x = {0, 0, 0}, q = {0, 0, 0}, eu = {0, 0, 0}, ev = {0, 0, 0};
             q[d] = 1;
-            mask.resize(sz[u] * sz[v]);
+            eu[u] = 1;
+            ev[v] = 1;
+            mask.resize(width * height);
 
-            for (x[d] = -1; x[d] < int(sz[d]);)
+            for (x[d] = int(min[d]); x[d] < int(max[d]); ++x[d])
             {
+                // A voxel has a face if its neighbour in the direction of the face is empty.
                 int n = 0;
-
-                // Create mask
-                for (x[v] = 0; x[v] < int(sz[v]); ++x[v])
-                    for (x[u] = 0; x[u] < int(sz[u]); ++x[u])
+                for (x[v] = int(min[v]); x[v] < int(max[v]); ++x[v])
+                    for (x[u] = int(min[u]); x[u] < int(max[u]); ++x[u])
                     {
-                        if (x[d] < 0)
-                            mask[n++] = back_face ? grid.get(x + q) : 0;
-                        else if (x[d] == int(sz[d]) - 1)
-                            mask[n++] = back_face ? 0 : grid.get(x);
-                        else if (grid.get(x) == 0 || grid.get(x + q) == 0)
-                            mask[n++] = back_face ? grid.get(x + q) : grid.get(x);
-                        else
-                            mask[n++] = 0;
+                        uint16_t mat = grid.get(x);
+                        glm::ivec3 neighbour = back_face ? x - q : x + q;
+                        if (mat != 0 && sample(grid, neighbour, outside) != 0)
+                            mat = 0;
+                        mask[n] = uint32_t(mat) << 16;
+                        if (mat != 0 && occlusion)
+                            mask[n] |= faceOcclusion(grid, outside, neighbour, eu, ev);
+                        n += 1;
                     }
 
-                ++x[d];
                 n = 0;
-
-                // Generate mesh from mask
-                for (int j = 0; j < int(sz[v]); ++j)
-                {
-                    for (int i = 0; i < int(sz[u]);)
+                for (int j = 0; j < height; ++j)
+                    for (int i = 0; i < width;)
                     {
-                        if (mask[n] != 0)
+                        if (mask[n] == 0)
+                        {
+                            ++i;
+                            ++n;
+                            continue;
+                        }
+
+                        int w, h;
+                        for (w = 1; i + w < width && mask[n + w] == mask[n]; ++w)
+                            ;
+                        for (h = 1; j + h < height; ++h)
                         {
-                            int w, h;
-                            for (w = 1; i + w < int(sz[u]) && mask[n + w] == mask[n]; ++w)
-                                ;
                             bool done = false;
-                            for (h = 1; j + h < int(sz[v]); ++h)
-                            {
-                                for (int k = 0; k < w; ++k)
-                                    if (mask[n + k + h * sz[u]] == 0 || mask[n + k + h * sz[u]] != mask[n])
-                                    {
-                                        done = true;
-                                        break;
-                                    }
-
-                                if (done)
-                                    break;
-                            }
+                            for (int k = 0; k < w && !done; ++k)
+                                done = mask[n + k + h * width] != mask[n];
+                            if (done)
+                                break;
+                        }
 
-                            if (mask[n] != 0)
-                            {
-                                x[u] = i;
-                                x[v] = j;
-
-                                glm::ivec3 du = {0, 0, 0}, dv = {0, 0, 0};
-                                du[u] = w;
-                                dv[v] = h;
-
-                                auto vi = vertices.size();
-                                vertices.resize(vi + 4, {{}, back_face ? -q : q, mask[n]});
-                                vertices[vi + 0].position = x;
-                                vertices[vi + 1].position = x + du;
-                                vertices[vi + 2].position = x + du + dv;
-                                vertices[vi + 3].position = x + dv;
-
-                                auto ii = indices.size();
-                                indices.resize(ii + 6);
-                                if (back_face)
-                                {
-                                    indices[ii + 0] = int(vi) + 0;
-                                    indices[ii + 1] = int(vi) + 2;
-                                    indices[ii + 2] = int(vi) + 1;
-                                    indices[ii + 3] = int(vi) + 3;
-                                    indices[ii + 4] = int(vi) + 2;
-                                    indices[ii + 5] = int(vi) + 0;
-                                }
-                                else
-                                {
-                                    indices[ii + 0] = int(vi) + 0;
-                                    indices[ii + 1] = int(vi) + 1;
-                                    indices[ii + 2] = int(vi) + 2;
-                                    indices[ii + 3] = int(vi) + 2;
-                                    indices[ii + 4] = int(vi) + 3;
-                                    indices[ii + 5] = int(vi) + 0;
-                                }
-                            }
+                        glm::ivec3 origin = x, du = {0, 0, 0}, dv = {0, 0, 0};
+                        origin[d] = back_face ? x[d] : x[d] + 1;
+                        origin[u] = int(min[u]) + i;
+                        origin[v] = int(min[v]) + j;
+                        du[u] = w;
+                        dv[v] = h;
+                        pushQuad(vertices, indices, origin, du, dv, q, back_face != 0, uint16_t(mask[n] >> 16),
+                                 uint8_t(mask[n]));
 
-                            for (int l = 0; l < h; ++l)
-                                for (int k = 0; k < w; ++k)
-                                    mask[n + k + l * sz[u]] = 0;
+                        for (int l = 0; l < h; ++l)
+                            for (int k = 0; k < w; ++k)
+                                mask[n + k + l * width] = 0;
 
-                            i += w;
-                            n += w;
-                        }
-                        else
+                        i += w;
+                        n += w;
+                    }
+            }
+        }
+}
+
+void cubos::core::gl::triangulate(const Grid& grid, const glm::uvec3& min, const glm::uvec3& max,
+                                  std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, bool occlusion)
+{
+    auto empty = [](const glm::ivec3&) -> uint16_t { return 0; };
+    triangulateRegion(grid, min, max, empty, vertices, indices, occlusion);
+}
+
+void cubos::core::gl::triangulate(const Grid& grid, const VoxelSampler& outside, std::vector<Vertex>& vertices,
+                                  std::vector<uint32_t>& indices, bool occlusion)
+{
+    triangulateRegion(grid, {0, 0, 0}, grid.getSize(), outside, vertices, indices, occlusion);
+}
+
+void cubos::core::gl::triangulate(const Grid& grid, const std::array<const Grid*, 6>& neighbours,
+                                  std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, bool occlusion)
+{
+    auto& sz = grid.getSize();
+    auto outside = [&](const glm::ivec3& x) -> uint16_t {
+        // Only the voxels right next to a face of the grid are in a neighbour, voxels next to its edges or corners
+        // are considered empty.
+        int face = -1;
+        glm::ivec3 local = x;
+        for (int d = 0; d < 3; ++d)
+        {
+            if (x[d] >= 0 && x[d] < int(sz[d]))
+                continue;
+            if (face != -1)
+                return 0;
+            face = d * 2 + (x[d] < 0 ? 1 : 0);
+        }
+
+        const Grid* neighbour = neighbours[face];
+        if (neighbour == nullptr)
+            return 0;
+
+        auto& nsz = neighbour->getSize();
+        int d = face / 2;
+        local[d] = face % 2 == 0 ? x[d] - int(sz[d]) : x[d] + int(nsz[d]);
+        if (local.x < 0 || local.y < 0 || local.z < 0 || local.x >= int(nsz.x) || local.y >= int(nsz.y) ||
+            local.z >= int(nsz.z))
+            return 0;
+        return neighbour->get(local);
+    };
+
+    triangulateRegion(grid, {0, 0, 0}, sz, outside, vertices, indices, occlusion);
+}
+
+void cubos::core::gl::triangulateBinary(const Grid& grid, std::vector<Vertex>& vertices,
+                                        std::vector<uint32_t>& indices)
+{
+    auto& sz = grid.getSize();
+    if (sz.x > 64 || sz.y > 64 || sz.z > 64)
+    {
+        triangulate(grid, vertices, indices);
+        return;
+    }
+
+    // Read each voxel only once.
+    std::vector<uint16_t> voxels(sz.x * sz.y * sz.z);
+    for (int z = 0, n = 0; z < int(sz.z); ++z)
+        for (int y = 0; y < int(sz.y); ++y)
+            for (int x = 0; x < int(sz.x); ++x)
+                voxels[n++] = grid.get({x, y, z});
+
+    // Faces of a single material on a slice, where bit u of row v is set if there's a face at (u, v).
+    struct Plane
+    {
+        uint16_t material;
+        std::array<uint64_t, 64> rows;
+    };
+    std::vector<std::vector<Plane>> slices;
+    std::vector<uint64_t> columns;
+
+    for (int back_face = 0; back_face < 2; ++back_face)
+        for (int d = 0; d < 3; ++d)
+        {
+            int u = (d + 1) % 3;
+            int v = (d + 2) % 3;
+            glm::ivec3 q = {0, 0, 0};
+            q[d] = 1;
+            glm::ivec3 stride = {1, int(sz.x), int(sz.x * sz.y)};
+
+            // Bit i of each column is set if the voxel at position i along the axis isn't empty.
+            columns.assign(sz[u] * sz[v], 0);
+            for (int b = 0; b < int(sz[v]); ++b)
+                for (int a = 0; a < int(sz[u]); ++a)
+                {
+                    uint64_t column = 0;
+                    for (int i = 0, n = a * stride[u] + b * stride[v]; i < int(sz[d]); ++i, n += stride[d])
+                        column |= uint64_t(voxels[n] != 0) << i;
+                    columns[a + b * sz[u]] = column;
+                }
+
+            // A voxel has a front face if the next voxel along the axis is empty, and a back face if the previous
+            // one is. Sort the faces into per-material planes of each slice.
+            slices.resize(sz[d]);
+            for (auto& planes : slices)
+                planes.clear();
+            for (int b = 0; b < int(sz[v]); ++b)
+                for (int a = 0; a < int(sz[u]); ++a)
+                {
+                    uint64_t column = columns[a + b * sz[u]];
+                    uint64_t faces = back_face ? column & ~(column << 1) : column & ~(column >> 1);
+                    while (faces != 0)
+                    {
+                        int i = std::countr_zero(faces);
+                        faces &= faces - 1;
+                        uint16_t material = voxels[a * stride[u] + b * stride[v] + i * stride[d]];
+                        auto& planes = slices[i];
+                        auto it = std::find_if(planes.begin(), planes.end(),
+                                               [&](const Plane& plane) { return plane.material == material; });
+                        if (it == planes.end())
                         {
-                            ++i;
-                            ++n;
+                            planes.push_back({material, {}});
+                            it = planes.end() - 1;
                         }
+                        it->rows[b] |= uint64_t(1) << a;
                     }
                 }
-            }
+
+            // Greedily merge the faces of each plane into quads: take the run of faces starting at the first face of
+            // a row, and extend it over the next rows while they contain the whole run.
+            for (int i = 0; i < int(sz[d]); ++i)
+                for (auto& plane : slices[i])
+                    for (int b = 0; b < int(sz[v]); ++b)
+                        while (plane.rows[b] != 0)
+                        {
+                            int a = std::countr_zero(plane.rows[b]);
+                            int w = std::countr_one(plane.rows[b] >> a);
+                            uint64_t run = (w == 64 ? ~uint64_t(0) : (uint64_t(1) << w) - 1) << a;
+                            plane.rows[b] &= ~run;
+
+                            int h = 1;
+                            for (; b + h < int(sz[v]) && (plane.rows[b + h] & run) == run; ++h)
+                                plane.rows[b + h] &= ~run;
+
+                            glm::ivec3 x = {0, 0, 0}, du = {0, 0, 0}, dv = {0, 0, 0};
+                            x[d] = back_face ? i : i + 1;
+                            x[u] = a;
+                            x[v] = b;
+                            du[u] = w;
+                            dv[v] = h;
+                            pushQuad(vertices, indices, x, du, dv, q, back_face != 0, plane.material);
+                        }
         }
-    } while (back_face != true);
+}
+
+std::future<Mesh> cubos::core::gl::triangulateAsync(const Grid& grid, ThreadPool& pool)
+{
+    auto promise = std::make_shared<std::promise<Mesh>>();
+    auto future = promise->get_future();
+    pool.addTask([&grid, &pool, promise]() {
+        Mesh mesh;
+        triangulate(grid, mesh.vertices, mesh.indices, pool);
+        promise->set_value(std::move(mesh));
+    });
+    return future;
 }
@@ -0,0 +1,154 @@
+#include <cubos/core/gl/voxel_world.hpp>
+#include <cubos/core/log.hpp>
+
+#include <cstdlib>
+
+using namespace cubos::core::gl;
+
+/// Floored division, so that negative positions map to negative chunks.
+static int floorDiv(int a, int b)
+{
+    return a / b - (a % b != 0 && (a < 0) != (b < 0));
+}
+
+glm::ivec3 VoxelWorld::toChunk(const glm::ivec3& position)
+{
+    return {floorDiv(position.x, ChunkSize), floorDiv(position.y, ChunkSize), floorDiv(position.z, ChunkSize)};
+}
+
+glm::ivec3 VoxelWorld::toLocal(const glm::ivec3& position)
+{
+    auto chunk = toChunk(position);
+    return {position.x - chunk.x * ChunkSize, position.y - chunk.y * ChunkSize, position.z - chunk.z * ChunkSize};
+}
+
+size_t VoxelWorld::ChunkHash::operator()(const glm::ivec3& chunk) const
+{
+    // Multiply each coordinate by a large prime, so that neighbouring chunks spread over the buckets.
+    return static_cast<size_t>(static_cast<uint32_t>(chunk.x) * 73856093u ^ static_cast<uint32_t>(chunk.y) * 19349663u ^
+                               static_cast<uint32_t>(chunk.z) * 83492791u);
+}
+
+uint16_t VoxelWorld::get(const glm::ivec3& position) const
+{
+    auto it = this->chunks.find(toChunk(position));
+    if (it == this->chunks.end())
+        return 0;
+    return it->second.grid.get(toLocal(position));
+}
+
+void VoxelWorld::set(const glm::ivec3& position, uint16_t mat)
+{
+    auto coords = toChunk(position);
+    auto it = this->chunks.find(coords);
+    if (it == this->chunks.end())
+    {
+        if (mat == 0)
+            return;
+        it = this->chunks.emplace(coords, Chunk{Grid({ChunkSize, ChunkSize, ChunkSize}), 0}).first;
+    }
+
+    auto& chunk = it->second;
+    auto local = toLocal(position);
+    uint16_t old = chunk.grid.get(local);
+    if ((old == 0) != (mat == 0))
+    {
+        if (mat == 0)
+        {
+            chunk.solidCount -= 1;
+            if (chunk.solidCount == 0)
+            {
+                this->chunks.erase(it);
+                return;
+            }
+        }
+        else
+            chunk.solidCount += 1;
+    }
+    chunk.grid.set(local, mat);
+}
+
+const Grid* VoxelWorld::getChunk(const glm::ivec3& chunk) const
+{
+    auto it = this->chunks.find(chunk);
+    if (it == this->chunks.end())
+        return nullptr;
+    return &it->second.grid;
+}
+
+void VoxelWorld::insertChunk(const glm::ivec3& chunk, Grid&& grid)
+{
+    if (grid.getSize() != glm::uvec3(ChunkSize, ChunkSize, ChunkSize))
+    {
+        logError("Could not insert chunk ({}, {}, {}): its grid must have {} voxels on each side.", chunk.x, chunk.y,
+                 chunk.z, ChunkSize);
+        return;
+    }
+
+    uint32_t solidCount = 0;
+    for (int z = 0; z < ChunkSize; ++z)
+        for (int y = 0; y < ChunkSize; ++y)
+            for (int x = 0; x < ChunkSize; ++x)
+                solidCount += grid.get({x, y, z}) != 0;
+
+    this->chunks.erase(chunk);
+    if (solidCount > 0)
+        this->chunks.emplace(chunk, Chunk{std::move(grid), solidCount});
+}
+
+void VoxelWorld::removeChunk(const glm::ivec3& chunk)
+{
+    this->chunks.erase(chunk);
+}
+
+size_t VoxelWorld::evict(const glm::ivec3& center, int radius,
+                         const std::function<void(const glm::ivec3&, Grid&&)>& onEvict)
+{
+    size_t count = 0;
+    for (auto it = this->chunks.begin(); it != this->chunks.end();)
+    {
+        const auto& coords = it->first;
+        if (std::abs(coords.x - center.x) > radius || std::abs(coords.y - center.y) > radius ||
+            std::abs(coords.z - center.z) > radius)
+        {
+            if (onEvict)
+                onEvict(coords, std::move(it->second.grid));
+            it = this->chunks.erase(it);
+            count += 1;
+        }
+        else
+            ++it;
+    }
+
+    return count;
+}
+
+void VoxelWorld::forEachChunk(const std::function<void(const glm::ivec3&, const Grid&)>& f) const
+{
+    for (const auto& [coords, chunk] : this->chunks)
+        f(coords, chunk.grid);
+}
+
+size_t VoxelWorld::getChunkCount() const
+{
+    return this->chunks.size();
+}
+
+void VoxelWorld::triangulateChunk(const glm::ivec3& chunk, std::vector<Vertex>& vertices,
+                                  std::vector<uint32_t>& indices, bool occlusion) const
+{
+    const Grid* grid = this->getChunk(chunk);
+    if (grid == nullptr)
+        return;
+
+    // The neighbouring voxels may be in any of the 26 chunks around this one, so look them up in the whole world.
+    glm::ivec3 origin = chunk * ChunkSize;
+    triangulate(
+        *grid, [&](const glm::ivec3& position) { return this->get(origin + position); }, vertices, indices,
+        occlusion);
+}
+
+void VoxelWorld::clear()
+{
+    this->chunks.clear();
+}
@@ -0,0 +1,135 @@
+#include <cubos/core/memory/binary_deserializer.hpp>
+#include <cubos/core/memory/endianness.hpp>
+
+using namespace cubos::core::memory;
+
+BinaryDeserializer::BinaryDeserializer(Stream& stream) : Deserializer(stream), hasFailed(false)
+{
+    // The end of the stream is found once, so that untrusted lengths can be checked against the bytes left.
+    auto start = stream.tell();
+    stream.seek(0, SeekOrigin::End);
+    this->end = stream.tell();
+    stream.seek(static_cast<int64_t>(start), SeekOrigin::Begin);
+}
+
+template <typename T> void BinaryDeserializer::readScalar(T& value)
+{
+    if (this->hasFailed || this->stream.read(&value, sizeof(value)) != sizeof(value))
+    {
+        this->hasFailed = true;
+        value = T{};
+        return;
+    }
+
+    value = fromLittleEndian(value);
+}
+
+size_t BinaryDeserializer::readLength()
+{
+    uint64_t length;
+    this->readScalar(length);
+
+    auto position = this->stream.tell();
+    if (!this->hasFailed && (position > this->end || length > this->end - position))
+        this->hasFailed = true;
+    return this->hasFailed ? 0 : static_cast<size_t>(length);
+}
+
+void BinaryDeserializer::read(int8_t& value)
+{
+    this->readScalar(value);
+}
+
+void BinaryDeserializer::read(int16_t& value)
+{
+    this->readScalar(value);
+}
+
+void BinaryDeserializer::read(int32_t& value)
+{
+    this->readScalar(value);
+}
+
+void BinaryDeserializer::read(int64_t& value)
+{
+    this->readScalar(value);
+}
+
+void BinaryDeserializer::read(uint8_t& value)
+{
+    this->readScalar(value);
+}
+
+void BinaryDeserializer::read(uint16_t& value)
+{
+    this->readScalar(value);
+}
+
+void BinaryDeserializer::read(uint32_t& value)
+{
+    this->readScalar(value);
+}
+
+void BinaryDeserializer::read(uint64_t& value)
+{
+    this->readScalar(value);
+}
+
+void BinaryDeserializer::read(float& value)
+{
+    this->readScalar(value);
+}
+
+void BinaryDeserializer::read(double& value)
+{
+    this->readScalar(value);
+}
+
+void BinaryDeserializer::read(bool& value)
+{
+    uint8_t byte;
+    this->readScalar(byte);
+    value = byte != 0;
+}
+
+void BinaryDeserializer::read(std::string& value)
+{
+    auto length = this->readLength();
+    value.resize(length);
+    if (length > 0 && this->stream.read(value.data(), length) != length)
+    {
+        this->hasFailed = true;
+        value.clear();
+    }
+}
+
+void BinaryDeserializer::beginObject()
+{
+}
+
+void BinaryDeserializer::endObject()
+{
+}
+
+size_t BinaryDeserializer::beginArray()
+{
+    return this->readLength();
+}
+
+void BinaryDeserializer::endArray()
+{
+}
+
+size_t BinaryDeserializer::beginDictionary()
+{
+    return this->readLength();
+}
+
+void BinaryDeserializer::endDictionary()
+{
+}
+
+bool BinaryDeserializer::failed() const
+{
+    return this->hasFailed;
+}
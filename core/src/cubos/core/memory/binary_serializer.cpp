@@ -0,0 +1,109 @@
+#include <cubos/core/memory/binary_serializer.hpp>
+#include <cubos/core/memory/endianness.hpp>
+
+#include <cstring>
+
+using namespace cubos::core::memory;
+
+BinarySerializer::BinarySerializer(Stream& stream) : Serializer(stream)
+{
+}
+
+void BinarySerializer::write(int8_t value, const char*)
+{
+    value = toLittleEndian(value);
+    this->stream.write(&value, sizeof(value));
+}
+
+void BinarySerializer::write(int16_t value, const char*)
+{
+    value = toLittleEndian(value);
+    this->stream.write(&value, sizeof(value));
+}
+
+void BinarySerializer::write(int32_t value, const char*)
+{
+    value = toLittleEndian(value);
+    this->stream.write(&value, sizeof(value));
+}
+
+void BinarySerializer::write(int64_t value, const char*)
+{
+    value = toLittleEndian(value);
+    this->stream.write(&value, sizeof(value));
+}
+
+void BinarySerializer::write(uint8_t value, const char*)
+{
+    value = toLittleEndian(value);
+    this->stream.write(&value, sizeof(value));
+}
+
+void BinarySerializer::write(uint16_t value, const char*)
+{
+    value = toLittleEndian(value);
+    this->stream.write(&value, sizeof(value));
+}
+
+void BinarySerializer::write(uint32_t value, const char*)
+{
+    value = toLittleEndian(value);
+    this->stream.write(&value, sizeof(value));
+}
+
+void BinarySerializer::write(uint64_t value, const char*)
+{
+    value = toLittleEndian(value);
+    this->stream.write(&value, sizeof(value));
+}
+
+void BinarySerializer::write(float value, const char*)
+{
+    value = toLittleEndian(value);
+    this->stream.write(&value, sizeof(value));
+}
+
+void BinarySerializer::write(double value, const char*)
+{
+    value = toLittleEndian(value);
+    this->stream.write(&value, sizeof(value));
+}
+
+void BinarySerializer::write(bool value, const char*)
+{
+    this->stream.put(value ? 1 : 0);
+}
+
+void BinarySerializer::write(const char* value, const char*)
+{
+    auto length = static_cast<uint64_t>(std::strlen(value));
+    this->write(length, nullptr);
+    this->stream.write(value, length);
+}
+
+void BinarySerializer::beginObject(const char*)
+{
+    // Objects are written as the sequence of their fields.
+}
+
+void BinarySerializer::endObject()
+{
+}
+
+void BinarySerializer::beginArray(size_t length, const char*)
+{
+    this->write(static_cast<uint64_t>(length), nullptr);
+}
+
+void BinarySerializer::endArray()
+{
+}
+
+void BinarySerializer::beginDictionary(size_t length, const char*)
+{
+    this->write(static_cast<uint64_t>(length), nullptr);
+}
+
+void BinarySerializer::endDictionary()
+{
+}
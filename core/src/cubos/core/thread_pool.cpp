@@ -0,0 +1,150 @@
+#include <cubos/core/thread_pool.hpp>
+
+#include <algorithm>
+
+using namespace cubos::core;
+
+/// Pool of the worker running on the current thread, if any.
+static thread_local ThreadPool* currentPool = nullptr;
+
+/// Index of the worker running on the current thread.
+static thread_local size_t currentWorker = 0;
+
+ThreadPool::ThreadPool(size_t threadCount) : pending(0), nextQueue(0), stopping(false)
+{
+    threadCount = std::max(threadCount, size_t(1));
+    for (size_t i = 0; i < threadCount; ++i)
+        this->queues.push_back(std::make_unique<Queue>());
+    for (size_t i = 0; i < threadCount; ++i)
+        this->threads.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(this->sleepMutex);
+        this->stopping = true;
+    }
+    this->wakeUp.notify_all();
+
+    for (auto& thread : this->threads)
+        thread.join();
+}
+
+size_t ThreadPool::getThreadCount() const
+{
+    return this->threads.size();
+}
+
+void ThreadPool::addTask(Task task)
+{
+    {
+        std::lock_guard lock(this->sleepMutex);
+        this->pending.fetch_add(1);
+    }
+
+    if (currentPool == this)
+    {
+        // Tasks spawned by a worker are kept on its own queue, as they probably touch the same data.
+        auto& queue = *this->queues[currentWorker];
+        std::lock_guard lock(queue.mutex);
+        queue.tasks.push_front(std::move(task));
+    }
+    else
+    {
+        auto& queue = *this->queues[this->nextQueue.fetch_add(1) % this->queues.size()];
+        std::lock_guard lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+
+    this->wakeUp.notify_one();
+}
+
+bool ThreadPool::runPendingTask()
+{
+    Task task;
+    if (!this->popTask(currentPool == this ? currentWorker : 0, task))
+        return false;
+    task();
+    return true;
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& f)
+{
+    grain = std::max(grain, size_t(1));
+    size_t chunks = (count + grain - 1) / grain;
+    if (chunks == 0)
+        return;
+
+    std::atomic<size_t> remaining(chunks);
+    for (size_t begin = 0; begin < count; begin += grain)
+    {
+        size_t end = std::min(begin + grain, count);
+        this->addTask([&f, &remaining, begin, end]() {
+            f(begin, end);
+            remaining.fetch_sub(1);
+        });
+    }
+
+    while (remaining.load() != 0)
+    {
+        if (!this->runPendingTask())
+            std::this_thread::yield();
+    }
+}
+
+bool ThreadPool::popTask(size_t index, Task& task)
+{
+    if (this->pending.load() == 0)
+        return false;
+
+    // First try the worker's own queue, from the front.
+    {
+        auto& queue = *this->queues[index];
+        std::lock_guard lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            this->pending.fetch_sub(1);
+            return true;
+        }
+    }
+
+    // Then steal from the back of the other queues.
+    for (size_t i = 1; i < this->queues.size(); ++i)
+    {
+        auto& queue = *this->queues[(index + i) % this->queues.size()];
+        std::lock_guard lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            this->pending.fetch_sub(1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t index)
+{
+    currentPool = this;
+    currentWorker = index;
+
+    while (true)
+    {
+        Task task;
+        if (this->popTask(index, task))
+        {
+            task();
+            continue;
+        }
+
+        std::unique_lock lock(this->sleepMutex);
+        this->wakeUp.wait(lock, [this]() { return this->stopping || this->pending.load() != 0; });
+        if (this->stopping && this->pending.load() == 0)
+            break;
+    }
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <cubos/core/gl/compressed_grid.hpp>
+
+#include <cstdlib>
+
+using namespace cubos::core;
+
+TEST(Cubos_Compressed_Grid, Matches_Grid)
+{
+    srand(1); // Seed the number random generation, so that the tests always produce the same results
+
+    glm::uvec3 size = {16, 16, 16};
+    gl::Grid grid(size);
+    gl::CompressedGrid compressed(size);
+    EXPECT_EQ(compressed.getBitsPerVoxel(), 0);
+
+    // Set random voxels with an increasing number of materials, so that the grid goes through every width.
+    uint8_t expectedBits[] = {1, 2, 4, 4, 8, 16};
+    uint16_t materialCounts[] = {2, 4, 10, 16, 200, 1000};
+    for (size_t step = 0; step < 6; ++step)
+    {
+        for (int i = 0; i < 2000; ++i)
+        {
+            glm::ivec3 position = {rand() % 16, rand() % 16, rand() % 16};
+            auto mat = static_cast<uint16_t>(rand() % materialCounts[step]);
+            grid.set(position, mat);
+            compressed.set(position, mat);
+        }
+        EXPECT_EQ(compressed.getBitsPerVoxel(), expectedBits[step]);
+    }
+
+    for (int z = 0; z < 16; ++z)
+        for (int y = 0; y < 16; ++y)
+            for (int x = 0; x < 16; ++x)
+                ASSERT_EQ(compressed.get({x, y, z}), grid.get({x, y, z}));
+}
+
+TEST(Cubos_Compressed_Grid, Compact_And_Run_Length)
+{
+    // A mostly empty chunk with a floor of two materials.
+    gl::Grid grid({32, 32, 32});
+    for (int z = 0; z < 32; ++z)
+        for (int x = 0; x < 32; ++x)
+            grid.set({x, 0, z}, x < 16 ? 1 : 2);
+
+    gl::CompressedGrid compressed(grid);
+    EXPECT_EQ(compressed.getBitsPerVoxel(), 2);
+    EXPECT_LE(compressed.getMemoryUsage() * 4, size_t(32 * 32 * 32 * 2));
+
+    // Overwriting a material and compacting narrows the indices.
+    for (int z = 0; z < 32; ++z)
+        for (int x = 16; x < 32; ++x)
+            compressed.set({x, 0, z}, 1);
+    EXPECT_EQ(compressed.getBitsPerVoxel(), 2);
+    compressed.compact();
+    EXPECT_EQ(compressed.getBitsPerVoxel(), 1);
+
+    compressed.compact(true);
+    EXPECT_EQ(compressed.getMode(), gl::CompressedGrid::Mode::RunLength);
+    EXPECT_LT(compressed.getMemoryUsage(), size_t(32 * 32 * 32 / 8));
+    EXPECT_EQ(compressed.get({3, 0, 3}), 1);
+    EXPECT_EQ(compressed.get({3, 1, 3}), 0);
+
+    // Setting a voxel goes back to the palette mode.
+    compressed.set({31, 31, 31}, 7);
+    EXPECT_EQ(compressed.getMode(), gl::CompressedGrid::Mode::Palette);
+    auto decompressed = compressed.decompress();
+    EXPECT_EQ(decompressed.get({31, 31, 31}), 7);
+    EXPECT_EQ(decompressed.get({20, 0, 5}), 1);
+    EXPECT_EQ(decompressed.get({20, 1, 5}), 0);
+}
@@ -0,0 +1,780 @@
+#include <gtest/gtest.h>
+#include <cubos/core/ecs/world.hpp>
+#include <cubos/core/ecs/world_view.hpp>
+#include <cubos/core/ecs/query.hpp>
+#include <cubos/core/ecs/commands.hpp>
+#include <cubos/core/ecs/hierarchy.hpp>
+#include <cubos/core/memory/buffer_stream.hpp>
+#include <cubos/core/ecs/vec_storage.hpp>
+#include <cubos/core/ecs/map_storage.hpp>
+#include <cubos/core/ecs/archetype_storage.hpp>
+#include <cubos/core/ecs/sparse_set_storage.hpp>
+#include <cubos/core/ecs/scheduler.hpp>
+#include <cubos/core/ecs/mask_matcher.hpp>
+#include <cubos/core/thread_pool.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+
+using namespace cubos::core;
+
+namespace
+{
+    struct ArchPosition
+    {
+        using Storage = ecs::ArchetypeStorage<ArchPosition>;
+        float x, y, z;
+    };
+
+    struct ArchVelocity
+    {
+        using Storage = ecs::ArchetypeStorage<ArchVelocity>;
+        float x, y, z;
+    };
+
+    struct ArchName
+    {
+        using Storage = ecs::ArchetypeStorage<ArchName>;
+        std::string name;
+    };
+
+    struct ArchHealth
+    {
+        using Storage = ecs::MapStorage<ArchHealth>;
+        int hp;
+    };
+
+    struct SparsePosition
+    {
+        using Storage = ecs::SparseSetStorage<SparsePosition>;
+        int x;
+    };
+
+    struct SparseTag
+    {
+        using Storage = ecs::SparseSetStorage<SparseTag>;
+        int value;
+    };
+
+    struct VecValue
+    {
+        using Storage = ecs::VecStorage<VecValue>;
+        int x;
+    };
+
+    struct SerializableName
+    {
+        using Storage = ecs::MapStorage<SerializableName>;
+        std::string name;
+
+        void serialize(memory::Serializer& s) const
+        {
+            s.write(name, "name");
+        }
+
+        void deserialize(memory::Deserializer& s)
+        {
+            s.read(name);
+        }
+    };
+} // namespace
+
+TEST(Cubos_ECS_Archetype_Storage, Migrate_On_Add_And_Remove)
+{
+    ecs::World world;
+    world.registerComponent<ArchPosition>();
+    world.registerComponent<ArchVelocity>();
+    world.registerComponent<ArchName>();
+    world.registerComponent<ArchHealth>();
+
+    auto e1 = world.create(ArchPosition{1, 2, 3}, ArchName{"first"});
+    auto e2 = world.create(ArchPosition{4, 5, 6});
+    world.addComponent<ArchVelocity>(e1, {7, 8, 9});
+
+    EXPECT_EQ(world.getComponent<ArchPosition>(e1)->y, 2);
+    EXPECT_EQ(world.getComponent<ArchVelocity>(e1)->z, 9);
+    EXPECT_EQ(world.getComponent<ArchName>(e1)->name, "first");
+    EXPECT_EQ(world.getComponent<ArchPosition>(e2)->x, 4);
+    EXPECT_EQ(world.getComponent<ArchVelocity>(e2), nullptr);
+
+    world.removeComponent<ArchPosition>(e1);
+    EXPECT_EQ(world.getComponent<ArchPosition>(e1), nullptr);
+    EXPECT_EQ(world.getComponent<ArchVelocity>(e1)->x, 7);
+    EXPECT_EQ(world.getComponent<ArchName>(e1)->name, "first");
+    EXPECT_EQ(world.getComponent<ArchPosition>(e2)->z, 6);
+
+    world.remove(e1);
+    EXPECT_EQ(world.getComponent<ArchPosition>(e2)->y, 5);
+}
+
+TEST(Cubos_ECS_Archetype_Storage, Iterate_Chunks)
+{
+    ecs::World world;
+    world.registerComponent<ArchPosition>();
+    world.registerComponent<ArchVelocity>();
+    world.registerComponent<ArchName>();
+    world.registerComponent<ArchHealth>();
+
+    // Enough entities to span several chunks.
+    const int count = 10000;
+    for (int i = 0; i < count; ++i)
+    {
+        auto entity = world.create(ArchPosition{float(i), 0, 0}, ArchVelocity{1, 0, 0});
+        if (i % 2 == 0)
+            world.addComponent<ArchHealth>(entity, {i});
+    }
+
+    size_t visited = 0;
+    world.forEachChunk<ArchPosition, ArchVelocity>(
+        [&](size_t n, const uint32_t* entities, ArchPosition* positions, ArchVelocity* velocities) {
+            for (size_t i = 0; i < n; ++i)
+            {
+                EXPECT_EQ(positions[i].x, float(entities[i]));
+                positions[i].x += velocities[i].x;
+            }
+            visited += n;
+        });
+    EXPECT_EQ(visited, count);
+
+    size_t matched = 0;
+    for (auto entity : ecs::WorldView<ArchPosition, ArchHealth>(world))
+    {
+        EXPECT_EQ(entity % 2, 0);
+        EXPECT_EQ(world.getComponent<ArchPosition>(entity)->x, float(entity + 1));
+        EXPECT_EQ(world.getComponent<ArchHealth>(entity)->hp, int(entity));
+        matched += 1;
+    }
+    EXPECT_EQ(matched, count / 2);
+}
+
+TEST(Cubos_ECS_Sparse_Set_Storage, Insert_Erase_And_Iterate)
+{
+    ecs::World world;
+    world.registerComponent<SparsePosition>();
+    world.registerComponent<SparseTag>();
+
+    std::vector<uint64_t> entities;
+    for (int i = 0; i < 100; ++i)
+        entities.push_back(world.create(SparsePosition{i}));
+    for (int i = 0; i < 100; i += 10)
+        world.addComponent<SparseTag>(entities[i], {i * 2});
+
+    // Erasing swaps the last value into the erased position, which must not affect other entities.
+    world.removeComponent<SparsePosition>(entities[0]);
+    world.removeComponent<SparseTag>(entities[10]);
+    EXPECT_EQ(world.getComponent<SparsePosition>(entities[0]), nullptr);
+    EXPECT_EQ(world.getComponent<SparseTag>(entities[10]), nullptr);
+    EXPECT_EQ(world.getComponent<SparsePosition>(entities[99])->x, 99);
+    EXPECT_EQ(world.getComponent<SparseTag>(entities[90])->value, 180);
+
+    std::vector<size_t> matched;
+    for (auto entity : ecs::WorldView<SparsePosition, SparseTag>(world))
+    {
+        EXPECT_EQ(world.getComponent<SparseTag>(entity)->value, world.getComponent<SparsePosition>(entity)->x * 2);
+        matched.push_back(entity);
+    }
+    std::sort(matched.begin(), matched.end());
+    EXPECT_EQ(matched, (std::vector<size_t>{20, 30, 40, 50, 60, 70, 80, 90}));
+}
+
+TEST(Cubos_ECS_World_View, For_Each_Parallel)
+{
+    ecs::World world;
+    world.registerComponent<ArchPosition>();
+    world.registerComponent<ArchVelocity>();
+    world.registerComponent<ArchName>();
+    world.registerComponent<ArchHealth>();
+
+    for (int i = 0; i < 5000; ++i)
+        world.create(ArchPosition{0, float(i), 0}, ArchVelocity{1, 2, 3});
+
+    cubos::core::ThreadPool pool(4);
+    ecs::WorldView<ecs::Write<ArchPosition>, ecs::Read<ArchVelocity>>(world).forEachParallel(
+        pool, [](size_t, ArchPosition& position, const ArchVelocity& velocity) {
+            position.x += velocity.x;
+            position.z += velocity.z;
+        });
+
+    for (auto entity : ecs::WorldView<ArchPosition>(world))
+    {
+        auto* position = world.getComponent<ArchPosition>(entity);
+        EXPECT_EQ(position->x, 1);
+        EXPECT_EQ(position->y, float(entity));
+        EXPECT_EQ(position->z, 3);
+    }
+
+    static_assert(ecs::hasConflictingAccess<ecs::Write<ArchPosition>, ecs::Read<ArchPosition>>());
+    static_assert(ecs::hasConflictingAccess<ArchVelocity, ecs::Read<ArchPosition>, ArchVelocity>());
+    static_assert(!ecs::hasConflictingAccess<ecs::Read<ArchPosition>, ecs::Read<ArchPosition>, ArchVelocity>());
+}
+
+TEST(Cubos_ECS_Query, Tracks_Component_Changes)
+{
+    ecs::World world;
+    world.registerComponent<ArchPosition>();
+    world.registerComponent<ArchVelocity>();
+    world.registerComponent<ArchName>();
+    world.registerComponent<ArchHealth>();
+
+    std::vector<uint64_t> entities;
+    for (int i = 0; i < 10; ++i)
+        entities.push_back(world.create(ArchPosition{float(i), 0, 0}));
+
+    // Queries created before and after the changes must match the same entities as a view.
+    ecs::Query<ArchPosition, ecs::Read<ArchHealth>> query(world);
+    EXPECT_EQ(query.size(), 0);
+
+    for (int i = 0; i < 10; i += 2)
+        world.addComponent<ArchHealth>(entities[i], {i});
+    world.addComponent<ArchHealth>(entities[4], {40});
+    world.removeComponent<ArchHealth>(entities[2]);
+    world.removeComponent<ArchHealth>(entities[2]);
+    world.removeComponent<ArchPosition>(entities[6]);
+    world.remove(entities[8]);
+    entities.push_back(world.create(ArchPosition{10, 0, 0}, ArchHealth{10}));
+
+    auto sorted = [](auto&& iterable) {
+        std::vector<size_t> result;
+        for (auto entity : iterable)
+            result.push_back(entity);
+        std::sort(result.begin(), result.end());
+        return result;
+    };
+    // The new entity reuses the index of the removed one, with a new version.
+    EXPECT_EQ(entities.back(), (uint64_t(1) << 32) | 8);
+    auto expected = std::vector<size_t>{0, 4, 8};
+    EXPECT_EQ(sorted(query), expected);
+    EXPECT_EQ(sorted(ecs::WorldView<ArchPosition, ArchHealth>(world)), expected);
+    EXPECT_EQ(sorted(ecs::Query<ArchHealth, ArchPosition>(world)), expected);
+    EXPECT_EQ(world.getComponent<ArchHealth>(entities[4])->hp, 40);
+}
+
+TEST(Cubos_ECS_Commands, Apply_Recorded_Changes)
+{
+    ecs::World world;
+    world.registerComponent<ArchPosition>();
+    world.registerComponent<ArchVelocity>();
+    world.registerComponent<ArchName>();
+    world.registerComponent<ArchHealth>();
+
+    for (int i = 0; i < 1000; ++i)
+        world.create(ArchPosition{float(i), 0, 0});
+
+    // Record commands from multiple threads while iterating a view, which only take effect on apply.
+    ecs::Commands commands(world);
+    cubos::core::ThreadPool pool(4);
+    ecs::WorldView<ecs::Read<ArchPosition>>(world).forEachParallel(
+        pool,
+        [&](size_t entity, const ArchPosition& position) {
+            if (entity % 2 == 0)
+            {
+                commands.remove(entity);
+                auto child = commands.create(ArchPosition{position.x, 1, 0});
+                commands.addComponent<ArchName>(child, {std::to_string(entity)});
+            }
+            else
+            {
+                commands.addComponent<ArchHealth>(entity, {int(entity)});
+            }
+        },
+        16);
+    EXPECT_EQ(world.getComponent<ArchHealth>(1), nullptr);
+
+    commands.apply();
+
+    size_t count = 0;
+    for (auto entity : ecs::WorldView<ArchPosition>(world))
+    {
+        auto* position = world.getComponent<ArchPosition>(entity);
+        if (entity < 1000)
+        {
+            EXPECT_EQ(entity % 2, 1);
+            EXPECT_EQ(world.getComponent<ArchHealth>(entity)->hp, int(entity));
+        }
+        else
+        {
+            EXPECT_EQ(position->y, 1);
+            EXPECT_EQ(world.getComponent<ArchName>(entity)->name, std::to_string(int(position->x)));
+        }
+        count += 1;
+    }
+    EXPECT_EQ(count, 1000);
+
+    // The buffer can be reused after being applied.
+    auto entity = commands.create(ArchHealth{7});
+    commands.apply();
+    EXPECT_EQ(world.getComponent<ArchHealth>(entity)->hp, 7);
+}
+
+TEST(Cubos_ECS_World, Create_And_Remove_Batch)
+{
+    ecs::World world;
+    world.registerComponent<ArchPosition>();
+    world.registerComponent<ArchVelocity>();
+    world.registerComponent<ArchName>();
+    world.registerComponent<ArchHealth>();
+    world.registerComponent<VecValue>();
+
+    auto single = world.create(ArchPosition{-1, 0, 0});
+    auto first = world.createBatch<ArchPosition, ArchVelocity, ArchHealth, VecValue>(
+        1000, [](size_t i, ArchPosition& position, ArchVelocity& velocity, ArchHealth& health, VecValue& value) {
+            position = {float(i), 0, 0};
+            velocity = {0, float(i), 0};
+            health = {int(i)};
+            value = {int(i) * 2};
+        });
+    EXPECT_EQ(first, single + 1);
+
+    std::vector<uint64_t> removed;
+    for (uint64_t i = 0; i < 1000; ++i)
+    {
+        EXPECT_EQ(world.getComponent<ArchPosition>(first + i)->x, float(i));
+        EXPECT_EQ(world.getComponent<ArchVelocity>(first + i)->y, float(i));
+        EXPECT_EQ(world.getComponent<ArchHealth>(first + i)->hp, int(i));
+        EXPECT_EQ(world.getComponent<VecValue>(first + i)->x, int(i) * 2);
+        EXPECT_EQ(world.getComponent<ArchName>(first + i), nullptr);
+        if (i % 3 == 0)
+            removed.push_back(first + i);
+    }
+
+    // Removing the same entity twice must be ignored.
+    removed.push_back(first);
+    world.removeBatch(removed);
+
+    size_t count = 0;
+    for (auto entity : ecs::WorldView<ArchPosition, ArchVelocity, VecValue>(world))
+    {
+        EXPECT_NE((entity - first) % 3, 0);
+        EXPECT_EQ(world.getComponent<VecValue>(entity)->x, int(entity - first) * 2);
+        count += 1;
+    }
+    EXPECT_EQ(count, 666);
+    EXPECT_EQ(world.getComponent<ArchPosition>(single)->x, -1);
+}
+
+TEST(Cubos_ECS_World, Component_IDs_Are_Per_World)
+{
+    // Each world identifies its components in the order they were registered.
+    ecs::World first;
+    EXPECT_EQ(first.registerComponent<ArchHealth>(), 0);
+    EXPECT_EQ(first.registerComponent<ArchPosition>(), 1);
+
+    ecs::World second;
+    EXPECT_EQ(second.registerComponent<ArchPosition>(), 0);
+    EXPECT_EQ(second.registerComponent<ArchVelocity>(), 1);
+    auto entity = second.create(ArchPosition{1, 2, 3}, ArchVelocity{4, 5, 6});
+
+    // Components may also be registered after entities were created.
+    EXPECT_EQ(second.registerComponent<ArchHealth>(), 2);
+    second.addComponent<ArchHealth>(entity, {10});
+    first.create(ArchHealth{20});
+
+    EXPECT_EQ(second.getComponent<ArchPosition>(entity)->y, 2);
+    EXPECT_EQ(second.getComponent<ArchHealth>(entity)->hp, 10);
+    EXPECT_EQ(first.getComponent<ArchPosition>(0), nullptr);
+    EXPECT_EQ(first.getComponent<ArchHealth>(0)->hp, 20);
+
+    size_t count = 0;
+    for (auto index : ecs::WorldView<ArchVelocity, ArchHealth>(second))
+    {
+        EXPECT_EQ(index, (uint32_t)entity);
+        count += 1;
+    }
+    EXPECT_EQ(count, 1);
+}
+
+TEST(Cubos_ECS_World, Reserve_Entities_In_Parallel)
+{
+    ecs::World world;
+    world.registerComponent<ArchPosition>();
+    world.registerComponent<ArchVelocity>();
+    world.registerComponent<ArchName>();
+    world.registerComponent<ArchHealth>();
+
+    std::vector<uint64_t> removed;
+    for (int i = 0; i < 100; ++i)
+    {
+        auto entity = world.create(ArchPosition{float(i), 0, 0});
+        if (i % 4 == 0)
+            removed.push_back(entity);
+    }
+    world.removeBatch(removed);
+
+    // Removed indices are handed out first, and then new ones, without duplicates.
+    std::vector<uint64_t> reserved(1000);
+    cubos::core::ThreadPool pool(4);
+    pool.parallelFor(reserved.size(), 16, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            reserved[i] = world.reserve();
+    });
+    world.createReserved();
+
+    std::sort(reserved.begin(), reserved.end(), [](uint64_t a, uint64_t b) { return (uint32_t)a < (uint32_t)b; });
+    for (size_t i = 0; i < reserved.size(); ++i)
+    {
+        uint32_t index = (uint32_t)reserved[i];
+        uint32_t expected = i < removed.size() ? (uint32_t)removed[i] : static_cast<uint32_t>(75 + i);
+        EXPECT_EQ(index, expected);
+        EXPECT_EQ(reserved[i] >> 32, i < removed.size() ? 1 : 0);
+        EXPECT_NE(world.addComponent<ArchHealth>(reserved[i], {int(i)}), nullptr);
+    }
+
+    for (auto entity : removed)
+        EXPECT_EQ(world.getComponent<ArchPosition>(entity), nullptr);
+}
+
+TEST(Cubos_ECS_World_View, Changed_And_Added_Filters)
+{
+    ecs::World world;
+    world.registerComponent<ArchPosition>();
+    world.registerComponent<ArchVelocity>();
+    world.registerComponent<ArchName>();
+    world.registerComponent<ArchHealth>();
+
+    for (int i = 0; i < 100; ++i)
+        world.create(ArchPosition{float(i), 0, 0}, ArchHealth{i});
+
+    auto collect = [](auto&& view) {
+        std::vector<size_t> result;
+        for (auto entity : view)
+            result.push_back(entity);
+        std::sort(result.begin(), result.end());
+        return result;
+    };
+
+    // On the first frame, everything was just added.
+    uint32_t last = world.advanceTick();
+    EXPECT_EQ(collect(ecs::WorldView<ecs::Added<ArchPosition>>(world, last - 1)).size(), 100);
+    EXPECT_EQ(collect(ecs::WorldView<ecs::Changed<ArchHealth>>(world, last)).size(), 0);
+
+    // Writing through a view marks only the visited entities.
+    cubos::core::ThreadPool pool(2);
+    ecs::WorldView<ecs::Write<ArchHealth>, ecs::Read<ArchPosition>>(world).forEachParallel(
+        pool, [](size_t, ArchHealth& health, const ArchPosition&) { health.hp += 1; }, 16);
+    world.markChanged<ArchPosition>(7);
+    world.addComponent<ArchPosition>(3, {});
+    world.addComponent<ArchVelocity>(5, {});
+
+    EXPECT_EQ(collect(ecs::WorldView<ecs::Changed<ArchHealth>>(world, last)).size(), 100);
+    EXPECT_EQ(collect(ecs::WorldView<ecs::Changed<ArchPosition>>(world, last)), (std::vector<size_t>{3, 7}));
+    EXPECT_EQ(collect(ecs::WorldView<ecs::Added<ArchPosition>>(world, last)).size(), 0);
+    EXPECT_EQ(collect(ecs::WorldView<ArchPosition, ecs::Added<ArchVelocity>>(world, last)),
+              (std::vector<size_t>{5}));
+
+    // Nothing changes on the next frame.
+    last = world.advanceTick();
+    EXPECT_EQ(collect(ecs::WorldView<ecs::Changed<ArchHealth>>(world, last)).size(), 0);
+}
+
+TEST(Cubos_ECS_World_View, Ticks_Move_With_Values)
+{
+    ecs::World world;
+    world.registerComponent<SparsePosition>();
+    world.registerComponent<ArchPosition>();
+    world.registerComponent<ArchVelocity>();
+
+    std::vector<uint64_t> entities;
+    for (int i = 0; i < 4; ++i)
+        entities.push_back(world.create(SparsePosition{i}, ArchPosition{float(i), 0, 0}));
+    uint32_t last = world.advanceTick();
+
+    // Only the last entity is marked, and then moved into the slots of the erased values.
+    world.markChanged<SparsePosition>(entities[3]);
+    world.markChanged<ArchPosition>(entities[3]);
+    world.removeComponent<SparsePosition>(entities[0]);
+    world.removeComponent<ArchPosition>(entities[0]);
+    world.addComponent<ArchVelocity>(entities[1], {});
+
+    auto collect = [](auto&& view) {
+        std::vector<size_t> result;
+        for (auto entity : view)
+            result.push_back(entity);
+        return result;
+    };
+
+    EXPECT_EQ(collect(ecs::WorldView<ecs::Changed<SparsePosition>>(world, last)), (std::vector<size_t>{3}));
+    EXPECT_EQ(collect(ecs::WorldView<ecs::Changed<ArchPosition>>(world, last)), (std::vector<size_t>{3}));
+    EXPECT_EQ(collect(ecs::WorldView<ecs::Added<ArchPosition>>(world, last)), (std::vector<size_t>{}));
+}
+
+TEST(Cubos_ECS_World, Snapshot_And_Restore)
+{
+    ecs::World world;
+    world.registerComponent<ArchPosition>();
+    world.registerComponent<ArchVelocity>();
+    world.registerComponent<ArchName>();
+    world.registerComponent<ArchHealth>();
+    world.registerComponent<VecValue>();
+    world.registerComponent<SerializableName>();
+
+    for (int i = 0; i < 100; ++i)
+    {
+        auto entity = world.create(ArchPosition{float(i), 0, 0}, VecValue{i});
+        if (i % 2 == 0)
+            world.addComponent<SerializableName>(entity, {std::to_string(i)});
+        if (i % 5 == 0)
+            world.addComponent<ArchName>(entity, {"not serializable"});
+        if (i % 3 == 0)
+            world.addComponent<ArchVelocity>(entity, {float(i), 0, 0});
+    }
+
+    std::vector<char> buffer(1 << 20);
+    memory::BufferStream stream(buffer.data(), buffer.size());
+    world.snapshot(stream);
+
+    // Change the world after taking the snapshot.
+    ecs::Query<ArchPosition, SerializableName> query(world);
+    world.removeComponent<SerializableName>(0);
+    world.getComponent<ArchPosition>(1)->x = -1;
+    world.remove(2);
+    world.create(ArchPosition{}, SerializableName{"new"});
+
+    stream.seek(0, memory::SeekOrigin::Begin);
+    ASSERT_TRUE(world.restore(stream));
+
+    size_t count = 0;
+    for (auto entity : ecs::WorldView<ArchPosition, VecValue>(world))
+    {
+        EXPECT_EQ(world.getComponent<ArchPosition>(entity)->x, float(entity));
+        EXPECT_EQ(world.getComponent<VecValue>(entity)->x, int(entity));
+        EXPECT_EQ(world.getComponent<ArchName>(entity), nullptr);
+        if (entity % 3 == 0)
+            EXPECT_EQ(world.getComponent<ArchVelocity>(entity)->x, float(entity));
+        else
+            EXPECT_EQ(world.getComponent<ArchVelocity>(entity), nullptr);
+        count += 1;
+    }
+    EXPECT_EQ(count, 100);
+    EXPECT_EQ(query.size(), 50);
+    for (auto entity : query)
+        EXPECT_EQ(world.getComponent<SerializableName>(entity)->name, std::to_string(entity));
+
+    // Streams which don't contain a snapshot are rejected.
+    std::vector<char> garbage(64, 'x');
+    memory::BufferStream invalid(garbage.data(), garbage.size());
+    EXPECT_FALSE(world.restore(invalid));
+
+    // Streams which end in the middle of the entities are rejected, and leave the world unchanged.
+    memory::BufferStream truncated(buffer.data(), sizeof(uint64_t) * 6);
+    EXPECT_FALSE(world.restore(truncated));
+    EXPECT_EQ(query.size(), 50);
+    EXPECT_EQ(world.getComponent<ArchPosition>(1)->x, 1.0f);
+
+    // Streams which end in the middle of the components restore the entities without the missing components.
+    ecs::World positions;
+    positions.registerComponent<ArchPosition>();
+    for (int i = 0; i < 10; ++i)
+        positions.create(ArchPosition{float(i), 0, 0});
+    memory::BufferStream positionsStream(buffer.data(), buffer.size());
+    positions.snapshot(positionsStream);
+    memory::BufferStream shortened(buffer.data(), positionsStream.tell() - 1);
+    EXPECT_FALSE(positions.restore(shortened));
+    EXPECT_EQ(positions.getComponent<ArchPosition>(0), nullptr);
+
+    // The same holds for components which are deserialized, such as those holding strings.
+    ecs::World names;
+    names.registerComponent<SerializableName>();
+    for (int i = 0; i < 10; ++i)
+        names.create(SerializableName{"name number " + std::to_string(i)});
+    memory::BufferStream namesStream(buffer.data(), buffer.size());
+    names.snapshot(namesStream);
+    memory::BufferStream shortenedNames(buffer.data(), namesStream.tell() - 4);
+    EXPECT_FALSE(names.restore(shortenedNames));
+    EXPECT_EQ(names.getComponent<SerializableName>(0), nullptr);
+    EXPECT_EQ(names.getComponent<SerializableName>(9), nullptr);
+}
+
+TEST(Cubos_ECS_Hierarchy, Propagates_Dirty_Transforms)
+{
+    auto translation = [](float x) { return glm::translate(glm::mat4(1.0f), glm::vec3(x, 0.0f, 0.0f)); };
+    auto worldX = [](ecs::Hierarchy& hierarchy, uint64_t entity) {
+        return hierarchy.getWorldTransform(entity)[3].x;
+    };
+
+    // Chain root <- a <- b, plus c as a separate root. The entities are added from the leaf up, so that the order
+    // must be rebuilt for parents to come first.
+    ecs::Hierarchy hierarchy;
+    uint64_t b = 0, a = 1, root = 2, c = 3;
+    hierarchy.add(b, translation(100));
+    hierarchy.add(a, translation(10));
+    hierarchy.add(root, translation(1));
+    hierarchy.add(c, translation(1000));
+    EXPECT_TRUE(hierarchy.setParent(a, root));
+    EXPECT_TRUE(hierarchy.setParent(b, a));
+    EXPECT_FALSE(hierarchy.setParent(root, b));
+    hierarchy.update();
+
+    EXPECT_EQ(worldX(hierarchy, root), 1);
+    EXPECT_EQ(worldX(hierarchy, a), 11);
+    EXPECT_EQ(worldX(hierarchy, b), 111);
+    EXPECT_EQ(worldX(hierarchy, c), 1000);
+    EXPECT_EQ(hierarchy.getParent(b), a);
+
+    std::vector<uint64_t> order;
+    hierarchy.forEach([&](uint64_t entity, const glm::mat4&) { order.push_back(entity); });
+    EXPECT_EQ(order, (std::vector<uint64_t>{root, c, a, b}));
+
+    // Changing a transform updates the whole subtree.
+    hierarchy.setLocalTransform(root, translation(2));
+    hierarchy.update();
+    EXPECT_EQ(worldX(hierarchy, b), 112);
+
+    // Removing an entity turns its children into roots.
+    hierarchy.remove(a);
+    hierarchy.update();
+    EXPECT_FALSE(hierarchy.contains(a));
+    EXPECT_EQ(hierarchy.getParent(b), UINT64_MAX);
+    EXPECT_EQ(worldX(hierarchy, b), 100);
+
+    hierarchy.setParent(b, c);
+    hierarchy.update();
+    EXPECT_EQ(worldX(hierarchy, b), 1100);
+
+    // Only the subtree below a dirty entity is recomputed.
+    hierarchy.setLocalTransform(root, translation(3));
+    hierarchy.setLocalTransform(b, translation(200));
+    hierarchy.update();
+    EXPECT_EQ(worldX(hierarchy, root), 3);
+    EXPECT_EQ(worldX(hierarchy, b), 1200);
+}
+
+TEST(Cubos_ECS_Hierarchy, Forgets_Removed_Entities)
+{
+    ecs::World world;
+    world.registerComponent<ArchPosition>();
+    auto parent = world.create(ArchPosition{});
+    auto child = world.create(ArchPosition{});
+
+    auto& hierarchy = world.getHierarchy();
+    hierarchy.add(parent, glm::translate(glm::mat4(1.0f), glm::vec3(5.0f, 0.0f, 0.0f)));
+    hierarchy.add(child);
+    EXPECT_TRUE(hierarchy.setParent(child, parent));
+    hierarchy.update();
+    EXPECT_EQ(hierarchy.getWorldTransform(child)[3].x, 5);
+
+    // Removing the parent from the world removes it from the hierarchy, and its index is reused by a new entity,
+    // which must not inherit anything.
+    world.remove(parent);
+    EXPECT_FALSE(hierarchy.contains(parent));
+    EXPECT_EQ(hierarchy.getParent(child), UINT64_MAX);
+    auto reused = world.create(ArchPosition{});
+    EXPECT_EQ(static_cast<uint32_t>(reused), static_cast<uint32_t>(parent));
+    EXPECT_FALSE(hierarchy.contains(reused));
+
+    hierarchy.update();
+    EXPECT_EQ(hierarchy.getWorldTransform(child)[3].x, 0);
+
+    std::vector<uint64_t> batch = {child};
+    world.removeBatch(batch);
+    EXPECT_FALSE(hierarchy.contains(child));
+}
+
+struct DeltaTime
+{
+    float value;
+};
+
+struct FrameCount
+{
+    int value;
+};
+
+TEST(Cubos_ECS_World, Read_And_Write_Resources)
+{
+    ecs::World world;
+    EXPECT_FALSE(world.hasResource<DeltaTime>());
+    world.insertResource(DeltaTime{0.5f});
+    world.insertResource<FrameCount>();
+    EXPECT_TRUE(world.hasResource<DeltaTime>());
+    EXPECT_EQ(world.read<FrameCount>()->value, 0);
+
+    // Systems which only read the same resource may run together, while writers are serialized.
+    using ReadDeltaTime = ecs::Read<ecs::Resource<DeltaTime>>;
+    using WriteFrameCount = ecs::Write<ecs::Resource<FrameCount>>;
+    ecs::Scheduler scheduler;
+    for (int i = 0; i < 8; ++i)
+    {
+        scheduler.addSystem<ReadDeltaTime, WriteFrameCount>("count", [](ecs::World& w) {
+            auto count = w.write<FrameCount>();
+            count->value += static_cast<int>(w.read<DeltaTime>()->value * 2.0f);
+        });
+    }
+
+    cubos::core::ThreadPool pool(4);
+    scheduler.run(world, pool);
+    EXPECT_EQ(world.read<FrameCount>().get().value, 8);
+
+    world.insertResource(DeltaTime{2.0f});
+    EXPECT_EQ(world.read<DeltaTime>()->value, 2.0f);
+    world.removeResource<DeltaTime>();
+    EXPECT_FALSE(world.hasResource<DeltaTime>());
+    EXPECT_TRUE(world.hasResource<FrameCount>());
+
+    // Accessing a type as a resource doesn't conflict with accessing it as a component.
+    ecs::System resourceWriter{"resource", {ecs::System::Access::of<WriteFrameCount>()}, false, {}};
+    ecs::System componentWriter{"component", {ecs::System::Access::of<ecs::Write<FrameCount>>()}, false, {}};
+    EXPECT_FALSE(resourceWriter.conflictsWith(componentWriter));
+    EXPECT_TRUE(resourceWriter.conflictsWith(resourceWriter));
+}
+
+TEST(Cubos_ECS_Scheduler, Conflicting_Systems_Run_In_Order)
+{
+    ecs::World world;
+    world.registerComponent<ArchPosition>();
+    world.registerComponent<ArchVelocity>();
+    world.registerComponent<ArchName>();
+    world.registerComponent<ArchHealth>();
+
+    auto entity = world.create(ArchPosition{0, 0, 0}, ArchVelocity{1, 1, 1});
+
+    std::atomic<int> step = 0;
+    ecs::Scheduler scheduler;
+    scheduler.addSystem<ecs::Write<ArchVelocity>>("accelerate", [&](ecs::World& w) {
+        EXPECT_EQ(step++, 0);
+        w.getComponent<ArchVelocity>(entity)->x = 2;
+    });
+    scheduler.addSystem<ecs::Write<ArchPosition>, ecs::Read<ArchVelocity>>("move", [&](ecs::World& w) {
+        EXPECT_EQ(step++, 1);
+        w.getComponent<ArchPosition>(entity)->x += w.getComponent<ArchVelocity>(entity)->x;
+    });
+    scheduler.addExclusiveSystem("check", [&](ecs::World& w) {
+        EXPECT_EQ(step++, 2);
+        EXPECT_EQ(w.getComponent<ArchPosition>(entity)->x, 2);
+    });
+
+    cubos::core::ThreadPool pool(4);
+    scheduler.run(world, pool);
+    EXPECT_EQ(step.load(), 3);
+    EXPECT_EQ(scheduler.getTimings().size(), 3);
+    EXPECT_EQ(scheduler.getTimings()[1].name, "move");
+}
+
+TEST(Cubos_ECS_Mask_Matcher, Matches_Scalar_Results)
+{
+    srand(1); // Seed the number random generation, so that the tests always produce the same results
+
+    for (size_t stride = 2; stride <= 3; ++stride)
+    {
+        const size_t count = 1003; // Not a multiple of the vector width, so that the scalar tail is also tested.
+        std::vector<uint32_t> data(count * stride);
+        for (auto& word : data)
+            word = static_cast<uint32_t>(rand()) & 0x3F;
+
+        uint32_t mask[] = {0x05, 0x02};
+        std::vector<uint32_t> expected, actual;
+        for (size_t i = 0; i < count; ++i)
+        {
+            bool matches = true;
+            for (size_t w = 0; w + 1 < stride; ++w)
+                matches = matches && (data[i * stride + 1 + w] & mask[w]) == mask[w];
+            if (matches)
+                expected.push_back(static_cast<uint32_t>(i));
+        }
+
+        ecs::matchMasks(data.data(), stride, count, mask, actual);
+        EXPECT_EQ(actual, expected);
+    }
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <cubos/core/gl/raycast.hpp>
+
+#include <cstdlib>
+
+using namespace cubos::core;
+
+TEST(Cubos_Raycast, Hits_First_Solid_Voxel)
+{
+    gl::Grid grid({16, 16, 16});
+    grid.set({5, 3, 3}, 2);
+    grid.set({9, 3, 3}, 4);
+
+    // From outside the grid, entering through its -X face.
+    gl::RaycastHit hit;
+    ASSERT_TRUE(gl::raycast(grid, {-10.0f, 3.5f, 3.5f}, {1.0f, 0.0f, 0.0f}, 100.0f, hit));
+    EXPECT_EQ(hit.position, glm::ivec3(5, 3, 3));
+    EXPECT_EQ(hit.normal, glm::ivec3(-1, 0, 0));
+    EXPECT_EQ(hit.material, 2);
+    EXPECT_FLOAT_EQ(hit.distance, 15.0f);
+
+    // From the other side, the other voxel is hit first.
+    ASSERT_TRUE(gl::raycast(grid, {12.5f, 3.5f, 3.5f}, {-2.0f, 0.0f, 0.0f}, 100.0f, hit));
+    EXPECT_EQ(hit.position, glm::ivec3(9, 3, 3));
+    EXPECT_EQ(hit.normal, glm::ivec3(1, 0, 0));
+    EXPECT_EQ(hit.material, 4);
+
+    // Starting inside a solid voxel.
+    ASSERT_TRUE(gl::raycast(grid, {5.5f, 3.5f, 3.5f}, {0.0f, 1.0f, 0.0f}, 100.0f, hit));
+    EXPECT_EQ(hit.position, glm::ivec3(5, 3, 3));
+    EXPECT_EQ(hit.normal, glm::ivec3(0, 0, 0));
+
+    // Misses, and hits which are too far away.
+    EXPECT_FALSE(gl::raycast(grid, {-10.0f, 4.5f, 3.5f}, {1.0f, 0.0f, 0.0f}, 100.0f, hit));
+    EXPECT_FALSE(gl::raycast(grid, {-10.0f, 3.5f, 3.5f}, {-1.0f, 0.0f, 0.0f}, 100.0f, hit));
+    EXPECT_FALSE(gl::raycast(grid, {-10.0f, 3.5f, 3.5f}, {1.0f, 0.0f, 0.0f}, 14.0f, hit));
+
+    // Diagonal rays enter voxels through the face they cross.
+    ASSERT_TRUE(gl::raycast(grid, {4.5f, 0.5f, 3.5f}, {0.3f, 1.0f, 0.0f}, 100.0f, hit));
+    EXPECT_EQ(hit.position, glm::ivec3(5, 3, 3));
+    EXPECT_EQ(hit.normal, glm::ivec3(0, -1, 0));
+}
+
+TEST(Cubos_Raycast, Pyramid_Matches_Plain_Raycast)
+{
+    srand(5); // Seed the number random generation, so that the tests always produce the same results
+
+    gl::Grid grid({64, 40, 50});
+    for (int i = 0; i < 60; ++i)
+        grid.set({rand() % 64, rand() % 40, rand() % 50}, static_cast<uint16_t>(1 + rand() % 5));
+
+    gl::OccupancyPyramid pyramid(grid);
+
+    auto random = []() { return float(rand()) / float(RAND_MAX); };
+    int hits = 0;
+    for (int i = 0; i < 2000; ++i)
+    {
+        glm::vec3 origin = {random() * 100.0f - 18.0f, random() * 80.0f - 20.0f, random() * 90.0f - 20.0f};
+        glm::vec3 target = {random() * 64.0f, random() * 40.0f, random() * 50.0f};
+        if (i % 3 == 0)
+            target.y = origin.y; // Rays parallel to a plane.
+
+        gl::RaycastHit plain, fast;
+        bool plainHit = gl::raycast(grid, origin, target - origin, 200.0f, plain);
+        bool fastHit = gl::raycast(grid, pyramid, origin, target - origin, 200.0f, fast);
+        ASSERT_EQ(plainHit, fastHit);
+        if (!plainHit)
+            continue;
+
+        hits += 1;
+        EXPECT_EQ(plain.position, fast.position);
+        EXPECT_EQ(plain.normal, fast.normal);
+        EXPECT_EQ(plain.material, fast.material);
+        EXPECT_NEAR(plain.distance, fast.distance, 1e-3f);
+    }
+    EXPECT_GT(hits, 0);
+
+    // The pyramid is updated after the grid changes.
+    grid.set({32, 20, 25}, 9);
+    pyramid.update(grid, {32, 20, 25}, {33, 21, 26});
+    gl::RaycastHit plain, fast;
+    ASSERT_TRUE(gl::raycast(grid, {32.5f, 20.5f, -5.0f}, {0.0f, 0.0f, 1.0f}, 200.0f, plain));
+    ASSERT_TRUE(gl::raycast(grid, pyramid, {32.5f, 20.5f, -5.0f}, {0.0f, 0.0f, 1.0f}, 200.0f, fast));
+    EXPECT_EQ(plain.position, fast.position);
+}
@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+#include <cubos/core/thread_pool.hpp>
+
+#include <atomic>
+#include <vector>
+
+TEST(Cubos_Thread_Pool, Parallel_For_Visits_Every_Element_Once)
+{
+    cubos::core::ThreadPool pool(4);
+
+    std::vector<int> visits(10000, 0);
+    pool.parallelFor(visits.size(), 64, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            visits[i] += 1;
+    });
+
+    for (auto v : visits)
+        EXPECT_EQ(v, 1);
+}
+
+TEST(Cubos_Thread_Pool, Nested_Parallel_For)
+{
+    cubos::core::ThreadPool pool(2);
+
+    // Workers which wait on nested loops must keep executing tasks, otherwise this would deadlock.
+    std::atomic<size_t> total = 0;
+    pool.parallelFor(16, 1, [&](size_t, size_t) {
+        pool.parallelFor(100, 10, [&](size_t begin, size_t end) { total += end - begin; });
+    });
+
+    EXPECT_EQ(total.load(), 1600);
+}
+
+TEST(Cubos_Thread_Pool, Pending_Tasks_Run_Before_Destruction)
+{
+    std::atomic<int> counter = 0;
+    {
+        cubos::core::ThreadPool pool(3);
+        for (int i = 0; i < 100; ++i)
+            pool.addTask([&]() { counter += 1; });
+    }
+
+    EXPECT_EQ(counter.load(), 100);
+}
@@ -0,0 +1,369 @@
+#include <gtest/gtest.h>
+#include <cubos/core/gl/grid.hpp>
+#include <cubos/core/gl/vertex.hpp>
+#include <cubos/core/gl/sectioned_mesh.hpp>
+#include <cubos/core/gl/lod.hpp>
+#include <cubos/core/gl/voxel_world.hpp>
+#include <cubos/core/memory/binary_deserializer.hpp>
+#include <cubos/core/memory/binary_serializer.hpp>
+#include <cubos/core/memory/buffer_stream.hpp>
+#include <cubos/core/thread_pool.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <vector>
+
+using namespace cubos::core;
+
+static void expectSameMesh(const gl::Mesh& a, const gl::Mesh& b)
+{
+    ASSERT_EQ(a.vertices.size(), b.vertices.size());
+    for (size_t i = 0; i < a.vertices.size(); ++i)
+    {
+        EXPECT_EQ(a.vertices[i].position, b.vertices[i].position);
+        EXPECT_EQ(a.vertices[i].normal, b.vertices[i].normal);
+        EXPECT_EQ(a.vertices[i].material, b.vertices[i].material);
+    }
+    EXPECT_EQ(a.indices, b.indices);
+}
+
+TEST(Cubos_Triangulation, Parallel_Matches_Single_Threaded)
+{
+    srand(1); // Seed the number random generation, so that the tests always produce the same results
+
+    gl::Grid grid({40, 24, 33});
+    for (int i = 0; i < 4000; ++i)
+        grid.set({rand() % 40, rand() % 24, rand() % 33}, static_cast<uint16_t>(1 + rand() % 3));
+
+    gl::Mesh expected;
+    gl::triangulate(grid, expected.vertices, expected.indices);
+    EXPECT_FALSE(expected.indices.empty());
+
+    ThreadPool pool(4);
+    gl::Mesh parallel;
+    gl::triangulate(grid, parallel.vertices, parallel.indices, pool);
+    expectSameMesh(parallel, expected);
+
+    auto future = gl::triangulateAsync(grid, pool);
+    expectSameMesh(future.get(), expected);
+}
+
+/// @return The quads of a mesh, each described by its positions, normal and material, sorted.
+static std::vector<std::array<int, 16>> sortedQuads(const gl::Mesh& mesh)
+{
+    std::vector<std::array<int, 16>> quads;
+    for (size_t i = 0; i + 3 < mesh.vertices.size(); i += 4)
+    {
+        std::array<int, 16> quad;
+        for (int k = 0; k < 4; ++k)
+            for (int c = 0; c < 3; ++c)
+                quad[k * 3 + c] = int(mesh.vertices[i + k].position[c]);
+        for (int c = 0; c < 3; ++c)
+            quad[12 + c] = int(mesh.vertices[i].normal[c]);
+        quad[15] = mesh.vertices[i].material;
+        quads.push_back(quad);
+    }
+    std::sort(quads.begin(), quads.end());
+    return quads;
+}
+
+TEST(Cubos_Triangulation, Binary_Matches_Greedy)
+{
+    srand(2); // Seed the number random generation, so that the tests always produce the same results
+
+    // Includes a grid which fills whole 64 bit columns.
+    for (auto size : {glm::uvec3{40, 24, 33}, glm::uvec3{64, 3, 64}, glm::uvec3{1, 1, 1}})
+    {
+        gl::Grid grid(size);
+        for (int i = 0; i < 3000; ++i)
+            grid.set({rand() % int(size.x), rand() % int(size.y), rand() % int(size.z)},
+                     static_cast<uint16_t>(rand() % 4));
+        for (int x = 0; x < int(size.x); ++x)
+            grid.set({x, 0, 0}, 1);
+
+        gl::Mesh greedy, binary;
+        gl::triangulate(grid, greedy.vertices, greedy.indices);
+        gl::triangulateBinary(grid, binary.vertices, binary.indices);
+        EXPECT_EQ(binary.indices.size(), greedy.indices.size());
+        EXPECT_EQ(sortedQuads(binary), sortedQuads(greedy));
+    }
+}
+
+TEST(Cubos_Triangulation, Sectioned_Mesh_Updates_Changed_Sections)
+{
+    srand(3); // Seed the number random generation, so that the tests always produce the same results
+
+    gl::Grid grid({40, 24, 33});
+    for (int i = 0; i < 4000; ++i)
+        grid.set({rand() % 40, rand() % 24, rand() % 33}, static_cast<uint16_t>(1 + rand() % 3));
+    grid.set({15, 3, 4}, 1);
+    grid.set({16, 3, 4}, 1);
+    grid.set({31, 15, 32}, 3);
+
+    // Triangulating the whole grid as a single region is the same as triangulating the grid.
+    gl::Mesh whole, region;
+    gl::triangulate(grid, whole.vertices, whole.indices);
+    gl::triangulate(grid, {0, 0, 0}, grid.getSize(), region.vertices, region.indices);
+    EXPECT_EQ(sortedQuads(region), sortedQuads(whole));
+
+    gl::SectionedMesh sectioned;
+    EXPECT_TRUE(sectioned.update(grid));
+    EXPECT_EQ(sectioned.getSectionCount(), 3 * 2 * 3);
+    EXPECT_FALSE(sectioned.update(grid));
+
+    // Setting a voxel to its current material doesn't dirty the grid.
+    glm::uvec3 min, max;
+    grid.set({5, 5, 5}, grid.get({5, 5, 5}));
+    EXPECT_FALSE(grid.getDirtyRegion(min, max));
+
+    // Change voxels next to the boundaries between sections.
+    grid.set({15, 3, 4}, 0);
+    grid.set({16, 3, 4}, 2);
+    grid.set({31, 15, 32}, 0);
+    ASSERT_TRUE(grid.getDirtyRegion(min, max));
+    EXPECT_EQ(min, glm::uvec3(15, 3, 4));
+    EXPECT_EQ(max, glm::uvec3(32, 16, 33));
+    EXPECT_TRUE(sectioned.update(grid));
+    EXPECT_FALSE(grid.getDirtyRegion(min, max));
+
+    gl::SectionedMesh fresh;
+    fresh.update(grid);
+
+    gl::Mesh updated, expected;
+    sectioned.build(updated);
+    fresh.build(expected);
+    expectSameMesh(updated, expected);
+
+    // Enabling ambient occlusion triangulates every section again.
+    sectioned.setOcclusion(true);
+    EXPECT_TRUE(sectioned.update(grid));
+    gl::SectionedMesh occluded(true);
+    occluded.update(grid);
+    sectioned.build(updated);
+    occluded.build(expected);
+    expectSameMesh(updated, expected);
+    for (size_t i = 0; i < updated.vertices.size(); ++i)
+        EXPECT_EQ(updated.vertices[i].occlusion, expected.vertices[i].occlusion);
+}
+
+TEST(Cubos_Triangulation, Sectioned_Mesh_Handles_Empty_Grids)
+{
+    // Grids can only become empty on an axis through deserialization.
+    std::vector<char> buffer(64);
+    memory::BufferStream stream(buffer.data(), buffer.size());
+    memory::BinarySerializer binarySerializer(stream);
+    memory::Serializer& serializer = binarySerializer;
+    serializer.write(glm::uvec3(20, 0, 20), "size");
+    serializer.write(std::vector<uint16_t>{}, "data");
+
+    stream.seek(0, memory::SeekOrigin::Begin);
+    memory::BinaryDeserializer binaryDeserializer(stream);
+    gl::Grid grid({20, 20, 20});
+    grid.deserialize(binaryDeserializer);
+    ASSERT_EQ(grid.getSize(), glm::uvec3(20, 0, 20));
+
+    gl::SectionedMesh sectioned;
+    EXPECT_TRUE(sectioned.update(grid));
+    EXPECT_EQ(sectioned.getSectionCount(), 0);
+    EXPECT_FALSE(sectioned.update(grid));
+
+    gl::Mesh mesh;
+    sectioned.build(mesh);
+    EXPECT_TRUE(mesh.vertices.empty());
+    EXPECT_TRUE(mesh.indices.empty());
+}
+
+TEST(Cubos_Triangulation, Downsamples_Levels_Of_Detail)
+{
+    // Blocks which are at least half solid get their most common material.
+    gl::Grid grid({5, 2, 2});
+    for (int i = 0; i < 8; ++i)
+        grid.set({i & 1, (i >> 1) & 1, i >> 2}, i < 3 ? 2 : 3);
+    grid.set({2, 0, 0}, 4);
+    grid.set({3, 1, 1}, 4);
+    grid.set({4, 0, 0}, 5);
+    grid.set({4, 1, 1}, 5);
+
+    auto half = gl::downsample(grid, 2);
+    EXPECT_EQ(half.getSize(), glm::uvec3(3, 1, 1));
+    EXPECT_EQ(half.get({0, 0, 0}), 3);
+    EXPECT_EQ(half.get({1, 0, 0}), 0);
+    EXPECT_EQ(half.get({2, 0, 0}), 5);
+
+    // Each level has fewer triangles than the previous one, and covers the same space.
+    gl::Grid sphere({32, 32, 32});
+    for (int z = 0; z < 32; ++z)
+        for (int y = 0; y < 32; ++y)
+            for (int x = 0; x < 32; ++x)
+                if ((x - 16) * (x - 16) + (y - 16) * (y - 16) + (z - 16) * (z - 16) < 15 * 15)
+                    sphere.set({x, y, z}, static_cast<uint16_t>(1 + (x + y + z) % 2));
+
+    std::vector<gl::Mesh> levels;
+    gl::triangulateLods(sphere, gl::MaxLodLevels, levels);
+    ASSERT_EQ(levels.size(), gl::MaxLodLevels);
+    for (size_t level = 1; level < levels.size(); ++level)
+    {
+        EXPECT_LT(levels[level].indices.size(), levels[level - 1].indices.size());
+        for (const auto& vertex : levels[level].vertices)
+        {
+            EXPECT_LE(vertex.position.x, 32u);
+            EXPECT_EQ(vertex.position.x % (1u << level), 0u);
+        }
+    }
+
+    EXPECT_EQ(gl::selectLod(10.0f, 64.0f, 4), 0);
+    EXPECT_EQ(gl::selectLod(100.0f, 64.0f, 4), 1);
+    EXPECT_EQ(gl::selectLod(200.0f, 64.0f, 4), 2);
+    EXPECT_EQ(gl::selectLod(10000.0f, 64.0f, 4), 3);
+    EXPECT_EQ(gl::selectLod(10000.0f, 64.0f, 2), 1);
+}
+
+TEST(Cubos_Triangulation, Sectioned_Lods_Update_Changed_Blocks)
+{
+    srand(4); // Seed the number random generation, so that the tests always produce the same results
+
+    gl::Grid grid({50, 37, 41});
+    for (int i = 0; i < 30000; ++i)
+        grid.set({rand() % 50, rand() % 37, rand() % 41}, static_cast<uint16_t>(1 + rand() % 3));
+
+    gl::SectionedLods lods;
+    EXPECT_TRUE(lods.update(grid));
+    EXPECT_FALSE(lods.update(grid));
+    auto coarse = gl::downsample(grid, 4);
+
+    // Carve a hole, as a destruction hit would.
+    for (int z = 20; z < 27; ++z)
+        for (int y = 10; y < 17; ++y)
+            for (int x = 30; x < 37; ++x)
+                grid.set({x, y, z}, 0);
+
+    // Downsampling only the changed region gives the same grid as downsampling everything.
+    glm::uvec3 min, max;
+    ASSERT_TRUE(grid.getDirtyRegion(min, max));
+    gl::downsample(grid, 4, coarse, min, max);
+    auto expectedCoarse = gl::downsample(grid, 4);
+    ASSERT_EQ(coarse.getSize(), expectedCoarse.getSize());
+    for (int z = 0; z < int(coarse.getSize().z); ++z)
+        for (int y = 0; y < int(coarse.getSize().y); ++y)
+            for (int x = 0; x < int(coarse.getSize().x); ++x)
+                EXPECT_EQ(coarse.get({x, y, z}), expectedCoarse.get({x, y, z}));
+
+    EXPECT_TRUE(lods.update(grid));
+    EXPECT_FALSE(grid.getDirtyRegion(min, max));
+
+    gl::SectionedLods fresh;
+    fresh.update(grid);
+
+    std::vector<gl::Mesh> updated, expected;
+    lods.build(updated);
+    fresh.build(expected);
+    ASSERT_EQ(updated.size(), gl::MaxLodLevels);
+    for (size_t level = 0; level < gl::MaxLodLevels; ++level)
+        expectSameMesh(updated[level], expected[level]);
+}
+
+TEST(Cubos_Triangulation, Bakes_Ambient_Occlusion)
+{
+    // A floor with a single voxel on top of it.
+    gl::Grid grid({3, 2, 3});
+    for (int z = 0; z < 3; ++z)
+        for (int x = 0; x < 3; ++x)
+            grid.set({x, 0, z}, 1);
+    grid.set({1, 1, 1}, 2);
+
+    gl::Mesh plain, occluded;
+    gl::triangulate(grid, {0, 0, 0}, grid.getSize(), plain.vertices, plain.indices);
+    gl::triangulate(grid, {0, 0, 0}, grid.getSize(), occluded.vertices, occluded.indices, true);
+
+    // Without occlusion the top of the floor is a single quad around the voxel, with occlusion it is split so that
+    // each quad has the same occlusion.
+    EXPECT_GT(occluded.indices.size(), plain.indices.size());
+    for (const auto& vertex : plain.vertices)
+        EXPECT_EQ(vertex.occlusion, 0);
+
+    int occludedCorners = 0;
+    for (const auto& vertex : occluded.vertices)
+    {
+        EXPECT_LE(vertex.occlusion, 3);
+        if (vertex.normal == glm::vec3(0, 1, 0) && vertex.position.y == 1 && vertex.occlusion > 0)
+        {
+            // Only the floor corners touching the voxel are occluded.
+            EXPECT_GE(vertex.position.x, 1u);
+            EXPECT_LE(vertex.position.x, 2u);
+            EXPECT_GE(vertex.position.z, 1u);
+            EXPECT_LE(vertex.position.z, 2u);
+            occludedCorners += 1;
+        }
+    }
+    EXPECT_GT(occludedCorners, 0);
+
+    // The faces of the voxel on top don't touch anything above the floor.
+    for (const auto& vertex : occluded.vertices)
+        if (vertex.position.y == 2)
+            EXPECT_EQ(vertex.occlusion, 0);
+}
+
+TEST(Cubos_Triangulation, Packs_Vertices)
+{
+    srand(4); // Seed the number random generation, so that the tests always produce the same results
+
+    gl::Grid grid({32, 32, 32});
+    for (int i = 0; i < 3000; ++i)
+        grid.set({rand() % 32, rand() % 32, rand() % 32}, static_cast<uint16_t>(1 + rand() % 300));
+
+    gl::Mesh mesh;
+    gl::triangulate(grid, {0, 0, 0}, grid.getSize(), mesh.vertices, mesh.indices, true);
+
+    std::vector<gl::PackedVertex> packed;
+    ASSERT_TRUE(gl::pack(mesh.vertices, packed));
+    ASSERT_EQ(packed.size(), mesh.vertices.size());
+    for (size_t i = 0; i < packed.size(); ++i)
+    {
+        auto vertex = gl::unpack(packed[i]);
+        EXPECT_EQ(vertex.position, mesh.vertices[i].position);
+        EXPECT_EQ(vertex.normal, mesh.vertices[i].normal);
+        EXPECT_EQ(vertex.material, mesh.vertices[i].material);
+        EXPECT_EQ(vertex.occlusion, mesh.vertices[i].occlusion);
+    }
+
+    // Coordinates above 255 don't fit.
+    mesh.vertices[0].position.y = 256;
+    EXPECT_FALSE(gl::pack(mesh.vertices, packed));
+    EXPECT_TRUE(packed.empty());
+}
+
+TEST(Cubos_Triangulation, Culls_Faces_Between_Chunks)
+{
+    gl::Grid a({4, 4, 4}), b({4, 4, 4});
+    for (int z = 0; z < 4; ++z)
+        for (int y = 0; y < 4; ++y)
+            for (int x = 0; x < 4; ++x)
+            {
+                a.set({x, y, z}, 1);
+                b.set({x, y, z}, x == 0 && y == 0 ? 0 : 2);
+            }
+
+    gl::Mesh alone, seamless;
+    gl::triangulate(a, alone.vertices, alone.indices);
+    gl::triangulate(a, {&b, nullptr, nullptr, nullptr, nullptr, nullptr}, seamless.vertices, seamless.indices);
+
+    // The +X face of a is only visible where b has a hole.
+    EXPECT_EQ(alone.vertices.size(), 6 * 4);
+    EXPECT_EQ(seamless.vertices.size(), 6 * 4);
+    for (const auto& vertex : seamless.vertices)
+        if (vertex.normal == glm::vec3(1, 0, 0))
+            EXPECT_LE(vertex.position.y, 1u);
+
+    // Chunks of a voxel world are triangulated against all the chunks around them.
+    gl::VoxelWorld world;
+    for (int z = 0; z < gl::VoxelWorld::ChunkSize; ++z)
+        for (int x = -gl::VoxelWorld::ChunkSize; x < gl::VoxelWorld::ChunkSize; ++x)
+            world.set({x, 0, z}, 1);
+
+    gl::Mesh chunk;
+    world.triangulateChunk({0, 0, 0}, chunk.vertices, chunk.indices);
+    EXPECT_EQ(chunk.vertices.size(), 5 * 4);
+    for (const auto& vertex : chunk.vertices)
+        EXPECT_NE(vertex.normal, glm::vec3(-1, 0, 0));
+}
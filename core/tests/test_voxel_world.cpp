@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include <cubos/core/gl/voxel_world.hpp>
+
+#include <vector>
+
+using namespace cubos::core;
+
+TEST(Cubos_Voxel_World, Allocates_And_Frees_Chunks)
+{
+    gl::VoxelWorld world;
+    EXPECT_EQ(world.get({5, 5, 5}), 0);
+
+    // Setting empty voxels doesn't allocate chunks.
+    world.set({5, 5, 5}, 0);
+    EXPECT_EQ(world.getChunkCount(), 0);
+
+    world.set({5, 5, 5}, 3);
+    world.set({-1, 0, 0}, 4);
+    world.set({-33, 64, 31}, 5);
+    EXPECT_EQ(world.getChunkCount(), 3);
+    EXPECT_EQ(world.get({5, 5, 5}), 3);
+    EXPECT_EQ(world.get({-1, 0, 0}), 4);
+    EXPECT_EQ(world.get({-33, 64, 31}), 5);
+    EXPECT_EQ(world.get({-2, 0, 0}), 0);
+
+    EXPECT_EQ(gl::VoxelWorld::toChunk({-1, 0, 0}), glm::ivec3(-1, 0, 0));
+    EXPECT_EQ(gl::VoxelWorld::toLocal({-1, 0, 0}), glm::ivec3(31, 0, 0));
+    EXPECT_EQ(gl::VoxelWorld::toChunk({-33, 64, 31}), glm::ivec3(-2, 2, 0));
+    ASSERT_NE(world.getChunk({-1, 0, 0}), nullptr);
+    EXPECT_EQ(world.getChunk({-1, 0, 0})->get({31, 0, 0}), 4);
+
+    // Overwriting a voxel keeps the chunk, emptying its last voxel frees it.
+    world.set({-1, 0, 0}, 6);
+    world.set({-1, 0, 0}, 0);
+    EXPECT_EQ(world.getChunk({-1, 0, 0}), nullptr);
+    EXPECT_EQ(world.getChunkCount(), 2);
+}
+
+TEST(Cubos_Voxel_World, Evicts_Distant_Chunks)
+{
+    gl::VoxelWorld world;
+    for (int x = -4; x <= 4; ++x)
+        world.set({x * gl::VoxelWorld::ChunkSize, 0, 0}, static_cast<uint16_t>(x + 5));
+
+    // Chunks more than one chunk away from the center are evicted, and can be inserted back later.
+    std::vector<glm::ivec3> evicted;
+    std::vector<gl::Grid> saved;
+    auto count = world.evict({1, 0, 0}, 1, [&](const glm::ivec3& chunk, gl::Grid&& grid) {
+        evicted.push_back(chunk);
+        saved.emplace_back(std::move(grid));
+    });
+    EXPECT_EQ(count, 6);
+    EXPECT_EQ(evicted.size(), 6);
+    EXPECT_EQ(world.getChunkCount(), 3);
+    EXPECT_EQ(world.get({4 * gl::VoxelWorld::ChunkSize, 0, 0}), 0);
+    EXPECT_EQ(world.get({2 * gl::VoxelWorld::ChunkSize, 0, 0}), 7);
+
+    for (size_t i = 0; i < evicted.size(); ++i)
+    {
+        if (evicted[i] == glm::ivec3(4, 0, 0))
+            world.insertChunk(evicted[i], std::move(saved[i]));
+    }
+    EXPECT_EQ(world.get({4 * gl::VoxelWorld::ChunkSize, 0, 0}), 9);
+    EXPECT_EQ(world.getChunkCount(), 4);
+}
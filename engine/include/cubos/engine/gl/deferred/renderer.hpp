@@ -84,7 +84,9 @@ namespace cubos::engine::gl::deferred
 
         //  Shader Pipeline
         core::gl::ShaderPipeline gBufferPipeline;
+        core::gl::ShaderPipeline gBufferPackedPipeline; ///< Used to draw the models with packed vertices.
         core::gl::ShaderBindingPoint mvpBP;
+        core::gl::ShaderBindingPoint packedMvpBP;
         core::gl::ConstantBuffer mvpBuffer;
         core::gl::RasterState rasterState;
         core::gl::BlendState blendState;
@@ -3,15 +3,20 @@
 
 #include <vector>
 #include <functional>
+#include <future>
 #include <list>
+#include <unordered_map>
 
 #include <cubos/core/gl/render_device.hpp>
 #include <cubos/core/gl/grid.hpp>
 #include <cubos/core/gl/vertex.hpp>
+#include <cubos/core/gl/sectioned_mesh.hpp>
+#include <cubos/core/gl/lod.hpp>
 #include <cubos/core/gl/palette.hpp>
 #include <cubos/core/gl/camera.hpp>
 #include <cubos/core/gl/light.hpp>
 #include <cubos/core/io/window.hpp>
+#include <cubos/core/thread_pool.hpp>
 #include <cubos/engine/gl/pps/pass.hpp>
 
 namespace cubos::engine::gl
@@ -30,7 +35,30 @@ namespace cubos::engine::gl
         virtual ~Renderer() = default;
         Renderer(const Renderer&) = delete;
 
+        /// Registers a model, which is triangulated in the background at every level of detail. The grid must not
+        /// be modified or destroyed until the next render.
+        /// @param grid The grid of the model.
+        /// @return The identifier of the model.
         virtual ModelID registerModel(const core::gl::Grid& grid) = 0;
+
+        /// Updates a registered model after the voxels of its grid changed. At every level of detail, only the
+        /// sections around the voxels changed since the last update are triangulated again, in the background, and the
+        /// buffers of the model are patched in place on the next render if the new mesh fits in them. The grid must
+        /// not be modified or destroyed until the next render.
+        /// @param modelID The model to update.
+        /// @param grid The grid of the model. Its dirty region is cleared.
+        virtual void updateModel(ModelID modelID, core::gl::Grid& grid);
+
+        /// Sets the distance up to which models are drawn at full resolution. Beyond it, each level of detail is used
+        /// up to twice the distance of the previous one.
+        /// @param distance The distance from the camera to the center of the model.
+        virtual void setLodDistance(float distance);
+
+        /// Sets whether the models registered or updated from now on have ambient occlusion baked into their meshes.
+        /// The next update of a model which was updated before with a different setting triangulates all of it.
+        /// @param enabled Whether ambient occlusion is enabled.
+        virtual void setAmbientOcclusion(bool enabled);
+
         virtual PaletteID registerPalette(const core::gl::Palette& palette);
         virtual void setPalette(PaletteID paletteID);
         virtual void addPostProcessingPass(const pps::Pass& pass);
@@ -46,8 +74,30 @@ namespace cubos::engine::gl
         struct RendererModel
         {
             core::gl::VertexArray va;
+            core::gl::VertexBuffer vb;
             core::gl::IndexBuffer ib;
             size_t numIndices;
+            size_t vertexCapacity; ///< Number of vertices which fit in the vertex buffer.
+            size_t indexCapacity;  ///< Number of indices which fit in the index buffer.
+            bool packed;           ///< Whether the vertex buffer stores PackedVertex instead of Vertex.
+        };
+
+        struct ModelLods
+        {
+            glm::vec3 center;                  ///< The center of the grid of the model, in model space.
+            std::vector<RendererModel> levels; ///< The model at each level of detail, starting at full resolution.
+        };
+
+        struct RegisterRequest
+        {
+            std::future<std::vector<core::gl::Mesh>> meshes; ///< The mesh of each level of detail.
+            glm::vec3 center;                                ///< The center of the grid of the model.
+        };
+
+        struct UpdateRequest
+        {
+            ModelID modelId;
+            std::future<std::vector<core::gl::Mesh>> meshes; ///< The new mesh of each level of detail, if any.
         };
 
         struct DrawRequest
@@ -58,14 +108,58 @@ namespace cubos::engine::gl
 
         explicit Renderer(core::io::Window& window);
         virtual RendererModel registerModelInternal(const core::gl::Grid& grid, core::gl::ShaderPipeline pipeline);
+        /// Uploads the mesh of a model. If a pipeline for packed vertices is given and every vertex of the mesh fits in
+        /// the packed format, the vertices are uploaded as PackedVertex, taking a quarter of the memory.
+        /// @param mesh The mesh of the model.
+        /// @param pipeline The pipeline used to render models with Vertex vertices.
+        /// @param packedPipeline The pipeline used to render models with PackedVertex vertices, or nullptr.
+        /// @return The new model.
+        virtual RendererModel registerModelInternal(const core::gl::Mesh& mesh, core::gl::ShaderPipeline pipeline,
+                                                    core::gl::ShaderPipeline packedPipeline = nullptr);
+
+        /// Replaces the mesh of a model, writing to its buffers if the mesh fits in them, or replacing them otherwise.
+        /// @param model The model to update.
+        /// @param mesh The new mesh of the model.
+        /// @param pipeline The pipeline used to render models with Vertex vertices.
+        /// @param packedPipeline The pipeline used to render models with PackedVertex vertices, or nullptr.
+        virtual void updateModelInternal(RendererModel& model, const core::gl::Mesh& mesh,
+                                         core::gl::ShaderPipeline pipeline,
+                                         core::gl::ShaderPipeline packedPipeline = nullptr);
+
+        /// Creates the buffers of a model, with room for a given number of vertices and indices.
+        /// @param mesh The mesh of the model.
+        /// @param pipeline The pipeline used to render models with Vertex vertices.
+        /// @param packedPipeline The pipeline used to render models with PackedVertex vertices, or nullptr.
+        /// @param usage The usage of the buffers.
+        /// @param vertexCapacity The number of vertices which fit in the vertex buffer.
+        /// @param indexCapacity The number of indices which fit in the index buffer.
+        /// @return The new model.
+        RendererModel createModel(const core::gl::Mesh& mesh, core::gl::ShaderPipeline pipeline,
+                                  core::gl::ShaderPipeline packedPipeline, core::gl::Usage usage,
+                                  size_t vertexCapacity, size_t indexCapacity);
+
+        /// Writes a mesh to the start of the buffers of a model, which must have room for it.
+        /// @param model The model to write to.
+        /// @param mesh The mesh to write.
+        /// @param packed The packed vertices of the mesh, used if the model stores packed vertices.
+        static void writeMesh(RendererModel& model, const core::gl::Mesh& mesh,
+                              const std::vector<core::gl::PackedVertex>& packed);
 
         virtual void executePostProcessing(core::gl::Framebuffer target);
 
-        std::vector<RendererModel> models;
+        std::vector<ModelLods> models;
         size_t modelCounter = 0;
         std::vector<core::gl::ConstantBuffer> palettes;
         core::gl::ConstantBuffer currentPalette;
-        std::vector<std::reference_wrapper<const core::gl::Grid>> registerRequests;
+        std::vector<RegisterRequest> registerRequests; ///< Meshes of the models registered this frame.
+        std::vector<UpdateRequest> updateRequests;     ///< Meshes of the models updated this frame.
+        float lodDistance = 64.0f;                     ///< Distance up to which models are drawn at full resolution.
+        bool ambientOcclusion = false;                 ///< Whether to bake ambient occlusion into the meshes.
+        std::unordered_map<ModelID, core::gl::SectionedLods> sectionedMeshes; ///< Sections of the updated models.
+
+        /// Pool where the grids of the registered and updated models are triangulated. Declared after the state its
+        /// tasks use, so that it's destroyed, waiting for the pending tasks, before that state.
+        core::ThreadPool meshingPool;
         std::vector<DrawRequest> drawRequests;
         std::vector<core::gl::SpotLight> spotLightRequests;
         std::vector<core::gl::DirectionalLight> directionalLightRequests;
@@ -20,9 +20,11 @@ void deferred::Renderer::createShaderPipelines()
             in uvec3 position;
             in vec3 normal;
             in uint material;
+            in uint occlusion;
 
             out vec3 fragPosition;
             out vec3 fragNormal;
+            out float fragOcclusion;
             flat out uint fragMaterial;
 
             uniform MVP
@@ -44,6 +46,7 @@ void deferred::Renderer::createShaderPipelines()
                 gl_Position = P * viewPosition;
 
                 fragMaterial = material;
+                fragOcclusion = 1.0 - 0.2 * float(occlusion);
             }
         )");
 
@@ -52,23 +55,65 @@ void deferred::Renderer::createShaderPipelines()
 
             in vec3 fragPosition;
             in vec3 fragNormal;
+            in float fragOcclusion;
             flat in uint fragMaterial;
 
             layout (location = 0) out vec3 position;
-            layout (location = 1) out vec3 normal;
+            layout (location = 1) out vec4 normal;
             layout (location = 2) out uint material;
 
             void main()
             {
                 position = fragPosition;
-                normal = normalize(fragNormal);
+                normal = vec4(normalize(fragNormal), fragOcclusion);
                 material = fragMaterial;
             }
         )");
 
+    // Same as gBufferVertex, but reading the normal and occlusion from the face index of packed vertices.
+    auto gBufferPackedVertex = renderDevice.createShaderStage(Stage::Vertex, R"(
+            #version 330 core
+
+            in uvec3 position;
+            in uint face;
+            in uint material;
+
+            out vec3 fragPosition;
+            out vec3 fragNormal;
+            out float fragOcclusion;
+            flat out uint fragMaterial;
+
+            uniform MVP
+            {
+                mat4 M;
+                mat4 V;
+                mat4 P;
+            };
+
+            const vec3 normals[6] = vec3[](vec3(1, 0, 0), vec3(-1, 0, 0), vec3(0, 1, 0),
+                                           vec3(0, -1, 0), vec3(0, 0, 1), vec3(0, 0, -1));
+
+            void main()
+            {
+                vec4 worldPosition = M * vec4(position, 1.0);
+                vec4 viewPosition = V * worldPosition;
+                fragPosition = vec3(worldPosition);
+
+                mat3 N = transpose(inverse(mat3(M)));
+                fragNormal = N * normals[face & 7u];
+
+                gl_Position = P * viewPosition;
+
+                fragMaterial = material;
+                fragOcclusion = 1.0 - 0.2 * float((face >> 3u) & 3u);
+            }
+        )");
+
     gBufferPipeline = renderDevice.createShaderPipeline(gBufferVertex, gBufferPixel);
+    gBufferPackedPipeline = renderDevice.createShaderPipeline(gBufferPackedVertex, gBufferPixel);
 
     mvpBP = gBufferPipeline->getBindingPoint("MVP");
+    packedMvpBP = gBufferPackedPipeline->getBindingPoint("MVP");
     mvpBuffer = renderDevice.createConstantBuffer(3 * sizeof(glm::mat4), nullptr, Usage::Dynamic);
 
     auto outputVertex = renderDevice.createShaderStage(Stage::Vertex, R"(
@@ -188,6 +233,7 @@ void deferred::Renderer::createShaderPipelines()
                 vec3 lighting = vec3(0);
                 vec3 fragPos = texture(position, fraguv).xyz;
                 vec3 fragNormal = texture(normal, fraguv).xyz;
+                float ambientOcclusion = texture(normal, fraguv).w;
                 for (uint i = 0u; i < numSpotLights; i++) {
                     lighting += spotLightCalc(fragPos, fragNormal, spotLights[i]);
                 }
@@ -197,7 +243,7 @@ void deferred::Renderer::createShaderPipelines()
                 for (uint i = 0u; i < numPointLights; i++) {
                     lighting += pointLightCalc(fragPos, fragNormal, pointLights[i]);
                 }
-                color = vec4(albedo * lighting, 1);
+                color = vec4(albedo * lighting * ambientOcclusion, 1);
             }
         )");
 
@@ -222,7 +268,7 @@ void deferred::Renderer::setupFrameBuffers()
     positionTex = renderDevice.createTexture2D(positionTexDesc);
 
     Texture2DDesc normalTexDesc;
-    normalTexDesc.format = TextureFormat::RGB32Float;
+    normalTexDesc.format = TextureFormat::RGBA32Float; // The alpha channel stores the ambient occlusion.
     normalTexDesc.width = sz.x;
     normalTexDesc.height = sz.y;
     normalTex = renderDevice.createTexture2D(normalTexDesc);
@@ -313,7 +359,12 @@ deferred::Renderer::Renderer(io::Window& window) : cubos::engine::gl::Renderer(w
 
 engine::gl::Renderer::ModelID deferred::Renderer::registerModel(const core::gl::Grid& grid)
 {
-    registerRequests.emplace_back(grid);
+    // Triangulate the grid in the background, so that the meshes are likely ready by the time they're uploaded on
+    // render.
+    RegisterRequest request;
+    request.meshes = triangulateLodsAsync(grid, MaxLodLevels, meshingPool, ambientOcclusion);
+    request.center = glm::vec3(grid.getSize()) / 2.0f;
+    registerRequests.push_back(std::move(request));
     return modelCounter++;
 }
 
@@ -352,12 +403,26 @@ void deferred::Renderer::drawLight(const PointLight& light)
 
 void deferred::Renderer::render(const Camera& camera, bool usePostProcessing)
 {
-    for (auto& grid : registerRequests)
+    for (auto& request : registerRequests)
     {
-        models.push_back(registerModelInternal(grid, gBufferPipeline));
+        auto& model = models.emplace_back();
+        model.center = request.center;
+        for (const auto& mesh : request.meshes.get())
+            model.levels.push_back(registerModelInternal(mesh, gBufferPipeline, gBufferPackedPipeline));
     }
     registerRequests.clear();
 
+    // Updates are applied after the registrations, as the updated models may have been registered this frame.
+    for (auto& request : updateRequests)
+    {
+        // The grid may not have changed since the last update, in which case there are no new meshes.
+        auto meshes = request.meshes.get();
+        auto& levels = models[request.modelId].levels;
+        for (size_t level = 0; level < levels.size() && level < meshes.size(); ++level)
+            updateModelInternal(levels[level], meshes[level], gBufferPipeline, gBufferPackedPipeline);
+    }
+    updateRequests.clear();
+
     renderDevice.setFramebuffer(camera.target);
     auto sz = window.getFramebufferSize();
 
@@ -374,20 +439,28 @@ void deferred::Renderer::render(const Camera& camera, bool usePostProcessing)
     renderDevice.clearDepth(1);
 
     mvpBP->bind(mvpBuffer);
+    packedMvpBP->bind(mvpBuffer);
 
     auto& mvp = *(MVP*)mvpBuffer->map();
     mvp.V = camera.viewMatrix;
     mvp.P = camera.perspectiveMatrix;
     mvpBuffer->unmap();
 
+    // Models are drawn with less detail the further they are from the camera.
+    glm::vec3 cameraPosition = glm::vec3(glm::inverse(camera.viewMatrix)[3]);
+
     for (auto& request : drawRequests)
     {
         auto& m = *(glm::mat4*)mvpBuffer->map();
         m = request.modelMat;
         mvpBuffer->unmap();
 
-        RendererModel& model = models[request.modelId];
+        auto& lods = models[request.modelId];
+        glm::vec3 center = glm::vec3(request.modelMat * glm::vec4(lods.center, 1.0f));
+        auto level = selectLod(glm::distance(center, cameraPosition), lodDistance, lods.levels.size());
+        RendererModel& model = lods.levels[level];
 
+        renderDevice.setShaderPipeline(model.packed ? gBufferPackedPipeline : gBufferPipeline);
         renderDevice.setVertexArray(model.va);
         renderDevice.setIndexBuffer(model.ib);
 
@@ -1,6 +1,10 @@
 #include <cubos/core/log.hpp>
 #include <cubos/engine/gl/renderer.hpp>
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
 using namespace cubos::core;
 using namespace cubos::core::gl;
 using namespace cubos::engine;
@@ -27,45 +31,175 @@ Renderer::Renderer(io::Window& window) : window(window), renderDevice(window.get
 
 Renderer::RendererModel Renderer::registerModelInternal(const core::gl::Grid& grid, ShaderPipeline pipeline)
 {
-    RendererModel model;
+    Mesh mesh;
+    triangulate(grid, mesh.vertices, mesh.indices, meshingPool);
+    return registerModelInternal(mesh, pipeline);
+}
+
+void Renderer::writeMesh(RendererModel& model, const core::gl::Mesh& mesh, const std::vector<PackedVertex>& packed)
+{
+    if (!mesh.vertices.empty())
+    {
+        if (model.packed)
+            memcpy(model.vb->map(), packed.data(), packed.size() * sizeof(PackedVertex));
+        else
+            memcpy(model.vb->map(), mesh.vertices.data(), mesh.vertices.size() * sizeof(Vertex));
+        model.vb->unmap();
+    }
+    if (!mesh.indices.empty())
+    {
+        memcpy(model.ib->map(), mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+        model.ib->unmap();
+    }
+    model.numIndices = mesh.indices.size();
+}
 
-    std::vector<Vertex> vertices;
-    std::vector<uint32_t> indices;
-    triangulate(grid, vertices, indices);
+Renderer::RendererModel Renderer::createModel(const core::gl::Mesh& mesh, ShaderPipeline pipeline,
+                                              ShaderPipeline packedPipeline, Usage usage, size_t vertexCapacity,
+                                              size_t indexCapacity)
+{
+    RendererModel model;
 
-    VertexBuffer vb = renderDevice.createVertexBuffer(vertices.size() * sizeof(Vertex), &vertices[0], Usage::Static);
+    std::vector<PackedVertex> packed;
+    model.packed = packedPipeline != nullptr && pack(mesh.vertices, packed);
 
     VertexArrayDesc vaDesc;
-    vaDesc.elementCount = 3;
-    vaDesc.elements[0].name = "position";
-    vaDesc.elements[0].type = Type::UInt;
-    vaDesc.elements[0].size = 3;
-    vaDesc.elements[0].buffer.index = 0;
-    vaDesc.elements[0].buffer.offset = offsetof(Vertex, position);
-    vaDesc.elements[0].buffer.stride = sizeof(Vertex);
-    vaDesc.elements[1].name = "normal";
-    vaDesc.elements[1].type = Type::Float;
-    vaDesc.elements[1].size = 3;
-    vaDesc.elements[1].buffer.index = 0;
-    vaDesc.elements[1].buffer.offset = offsetof(Vertex, normal);
-    vaDesc.elements[1].buffer.stride = sizeof(Vertex);
-    vaDesc.elements[2].name = "material";
-    vaDesc.elements[2].type = Type::UShort;
-    vaDesc.elements[2].size = 1;
-    vaDesc.elements[2].buffer.index = 0;
-    vaDesc.elements[2].buffer.offset = offsetof(Vertex, material);
-    vaDesc.elements[2].buffer.stride = sizeof(Vertex);
-    vaDesc.buffers[0] = vb;
-    vaDesc.shaderPipeline = pipeline;
+    if (model.packed)
+    {
+        model.vb = renderDevice.createVertexBuffer(vertexCapacity * sizeof(PackedVertex), nullptr, usage);
+
+        vaDesc.elementCount = 3;
+        vaDesc.elements[0].name = "position";
+        vaDesc.elements[0].type = Type::UByte;
+        vaDesc.elements[0].size = 3;
+        vaDesc.elements[0].buffer.index = 0;
+        vaDesc.elements[0].buffer.offset = offsetof(PackedVertex, position);
+        vaDesc.elements[0].buffer.stride = sizeof(PackedVertex);
+        vaDesc.elements[1].name = "face";
+        vaDesc.elements[1].type = Type::UByte;
+        vaDesc.elements[1].size = 1;
+        vaDesc.elements[1].buffer.index = 0;
+        vaDesc.elements[1].buffer.offset = offsetof(PackedVertex, face);
+        vaDesc.elements[1].buffer.stride = sizeof(PackedVertex);
+        vaDesc.elements[2].name = "material";
+        vaDesc.elements[2].type = Type::UShort;
+        vaDesc.elements[2].size = 1;
+        vaDesc.elements[2].buffer.index = 0;
+        vaDesc.elements[2].buffer.offset = offsetof(PackedVertex, material);
+        vaDesc.elements[2].buffer.stride = sizeof(PackedVertex);
+        vaDesc.shaderPipeline = packedPipeline;
+    }
+    else
+    {
+        model.vb = renderDevice.createVertexBuffer(vertexCapacity * sizeof(Vertex), nullptr, usage);
+
+        vaDesc.elementCount = 4;
+        vaDesc.elements[0].name = "position";
+        vaDesc.elements[0].type = Type::UInt;
+        vaDesc.elements[0].size = 3;
+        vaDesc.elements[0].buffer.index = 0;
+        vaDesc.elements[0].buffer.offset = offsetof(Vertex, position);
+        vaDesc.elements[0].buffer.stride = sizeof(Vertex);
+        vaDesc.elements[1].name = "normal";
+        vaDesc.elements[1].type = Type::Float;
+        vaDesc.elements[1].size = 3;
+        vaDesc.elements[1].buffer.index = 0;
+        vaDesc.elements[1].buffer.offset = offsetof(Vertex, normal);
+        vaDesc.elements[1].buffer.stride = sizeof(Vertex);
+        vaDesc.elements[2].name = "material";
+        vaDesc.elements[2].type = Type::UShort;
+        vaDesc.elements[2].size = 1;
+        vaDesc.elements[2].buffer.index = 0;
+        vaDesc.elements[2].buffer.offset = offsetof(Vertex, material);
+        vaDesc.elements[2].buffer.stride = sizeof(Vertex);
+        vaDesc.elements[3].name = "occlusion";
+        vaDesc.elements[3].type = Type::UByte;
+        vaDesc.elements[3].size = 1;
+        vaDesc.elements[3].buffer.index = 0;
+        vaDesc.elements[3].buffer.offset = offsetof(Vertex, occlusion);
+        vaDesc.elements[3].buffer.stride = sizeof(Vertex);
+        vaDesc.shaderPipeline = pipeline;
+    }
+    vaDesc.buffers[0] = model.vb;
 
     model.va = renderDevice.createVertexArray(vaDesc);
-    model.ib =
-        renderDevice.createIndexBuffer(indices.size() * sizeof(size_t), &indices[0], IndexFormat::UInt, Usage::Static);
-    model.numIndices = indices.size();
+    model.ib = renderDevice.createIndexBuffer(indexCapacity * sizeof(uint32_t), nullptr, IndexFormat::UInt, usage);
+    model.vertexCapacity = vertexCapacity;
+    model.indexCapacity = indexCapacity;
+    writeMesh(model, mesh, packed);
 
     return model;
 }
 
+Renderer::RendererModel Renderer::registerModelInternal(const core::gl::Mesh& mesh, ShaderPipeline pipeline,
+                                                        ShaderPipeline packedPipeline)
+{
+    return createModel(mesh, pipeline, packedPipeline, Usage::Static, mesh.vertices.size(), mesh.indices.size());
+}
+
+void Renderer::updateModelInternal(RendererModel& model, const core::gl::Mesh& mesh, ShaderPipeline pipeline,
+                                   ShaderPipeline packedPipeline)
+{
+    std::vector<PackedVertex> packed;
+    bool canPack = packedPipeline != nullptr && pack(mesh.vertices, packed);
+    if (canPack != model.packed || mesh.vertices.size() > model.vertexCapacity ||
+        mesh.indices.size() > model.indexCapacity)
+    {
+        // Leave some room for the mesh to grow, so that the next updates can write to the same buffers.
+        model = createModel(mesh, pipeline, packedPipeline, Usage::Dynamic, mesh.vertices.size() * 3 / 2,
+                            mesh.indices.size() * 3 / 2);
+        return;
+    }
+
+    writeMesh(model, mesh, packed);
+}
+
+void Renderer::updateModel(ModelID modelID, core::gl::Grid& grid)
+{
+    if (modelID >= modelCounter)
+    {
+        logError("Renderer::updateModel() failed: no model was registered with modelID \"{}\"", modelID);
+        return;
+    }
+
+    // The sections of a model are only touched by one task at a time, so a second update in the same frame waits for
+    // the first one, whose meshes are kept unless the second one replaces them.
+    std::vector<Mesh> previous;
+    auto it = std::find_if(updateRequests.begin(), updateRequests.end(),
+                           [modelID](const UpdateRequest& request) { return request.modelId == modelID; });
+    if (it == updateRequests.end())
+    {
+        it = updateRequests.emplace(updateRequests.end());
+        it->modelId = modelID;
+    }
+    else
+        previous = it->meshes.get();
+
+    // The first update of a model triangulates every section of every level of detail, the following ones only the
+    // sections around the changed voxels.
+    auto& sections = sectionedMeshes[modelID];
+    sections.setOcclusion(ambientOcclusion);
+
+    auto promise = std::make_shared<std::promise<std::vector<Mesh>>>();
+    it->meshes = promise->get_future();
+    meshingPool.addTask([&sections, &grid, promise, previous = std::move(previous)]() mutable {
+        std::vector<Mesh> meshes = std::move(previous);
+        if (sections.update(grid))
+            sections.build(meshes);
+        promise->set_value(std::move(meshes));
+    });
+}
+
+void Renderer::setLodDistance(float distance)
+{
+    lodDistance = distance;
+}
+
+void Renderer::setAmbientOcclusion(bool enabled)
+{
+    ambientOcclusion = enabled;
+}
+
 Renderer::PaletteID Renderer::registerPalette(const Palette& palette)
 {
     auto materials = palette.getData();
@@ -115,7 +249,7 @@ void Renderer::executePostProcessing(Framebuffer target)
 
 void Renderer::drawModel(ModelID modelID, glm::mat4 modelMat)
 {
-    if (modelID > modelCounter - 1)
+    if (modelID >= modelCounter)
     {
         logError("DeferredRenderer::drawModel() failed: no model was registered with modelID \"{}\"", modelID);
         return;